@@ -7,6 +7,7 @@
 #include "Game/RemoteServer.hpp"
 #include "Game/NetworkObserver.hpp"
 #include "Game/NetworkMessage.hpp"
+#include "Game/NetIOThread.hpp"
 #include "Engine/Core/NamedStrings.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Job.hpp"
@@ -23,7 +24,6 @@
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Platform/Window.hpp"
 #include "Engine/Network/Network.hpp"
-#include "Engine/Network/TCPServer.hpp"
 
 static NamedProperties props;
 
@@ -37,16 +37,25 @@ COMMAND(StartMultiplayerServer, "start server, port=48000", eEventFlag::EVENT_CO
 }
 
 //////////////////////////////////////////////////////////////////////////
-COMMAND(ConnectToMultiplayerServer, "connect server, ip=127.0.0.1, port=48000", eEventFlag::EVENT_CONSOLE)
+COMMAND(ConnectToMultiplayerServer, "connect server, ip=127.0.0.1, port=48000, replyip=own address if server not local", eEventFlag::EVENT_CONSOLE)
 {
 	std::string ip = args.GetValue("ip","127.0.0.1");
 	int port = args.GetValue("port",48000);
+	std::string replyIP = args.GetValue("replyip", "");
 	if (ip == "127.0.0.1" && port == 48000) {
 		ip=args.GetValue("0", "127.0.0.1");
 		port = args.GetValue("1", 48000);
+		replyIP = args.GetValue("2", replyIP);
+	}
+	if (replyIP.empty() && ip == "127.0.0.1") {
+		replyIP = ip;
+	}
+	if (replyIP.empty()) {
+		g_theConsole->PrintError("Remote server needs replyip, the address it can reach this machine on");
+		return false;
 	}
 
-	g_theApp->StartClient(GAME_MULTI_PLAYER, ip, port);
+	g_theApp->StartClient(GAME_MULTI_PLAYER, ip, port, replyIP);
 	return true;
 }
 
@@ -88,6 +97,8 @@ void App::Startup()
 	g_theConsole->Startup();
     g_theAudio->Startup();
     g_theNetwork->Startup(); 
+    g_theNetIO = new NetIOThread();
+    g_theNetIO->Startup();
 
     g_theServer = new AuthoritativeServer();
     g_theClient = new PlayerClient();
@@ -105,6 +116,7 @@ void App::Shutdown()
 	Clock::SystemShutdown();
 
 	g_theServer->Shutdown();
+	g_theNetIO->Shutdown();
 	g_theNetwork->Shutdown();
     g_theAudio->Shutdown();
     g_theRenderer->Shutdown();
@@ -125,6 +137,9 @@ void App::Shutdown()
     g_theAudio = nullptr;
     g_theInput = nullptr;
 
+	delete g_theNetIO;
+	g_theNetIO = nullptr;
+
 	delete g_theNetwork;
 	g_theNetwork = nullptr;
 
@@ -160,7 +175,7 @@ void App::StartServer(eGameType gameType, int port)
 	ClearExistingServerAndClient();	
 
 	AuthoritativeServer* authorServer = new AuthoritativeServer();
-	authorServer->SetUpTCPServer(port);
+	authorServer->Listen(port);
 	g_theServer = static_cast<Server*>(authorServer);
 	g_theClient = new PlayerClient();
     g_theServer->Startup(gameType);
@@ -168,12 +183,12 @@ void App::StartServer(eGameType gameType, int port)
 }
 
 //////////////////////////////////////////////////////////////////////////
-void App::StartClient(eGameType gameType, std::string const& serverIP, int serverPort)
+void App::StartClient(eGameType gameType, std::string const& serverIP, int serverPort, std::string const& replyIP)
 {
 	ClearExistingServerAndClient();
 
 	RemoteServer* remoServer = new RemoteServer();
-	remoServer->SetUpTCPClient(serverIP,serverPort);
+	remoServer->Connect(serverIP, serverPort, replyIP);
 	g_theServer = static_cast<Server*>(remoServer);
 	g_theClient = new PlayerClient();
 	g_theServer->Startup(gameType);
@@ -199,6 +214,7 @@ void App::BeginFrame()
 
 	m_theWindow->BeginFrame();
 	g_theNetwork->BeginFrame();
+	g_theObserver->BeginFrame();
 	g_theServer->BeginFrame();
 
 	JobSystemBeginFrame();
@@ -240,8 +256,7 @@ void App::EndFrame()
 //////////////////////////////////////////////////////////////////////////
 void App::ClearExistingServerAndClient()
 {
-    g_theNetwork->DisconnectClients();
-	g_theNetwork->StopServers();
+    g_theNetIO->Flush();
 	g_theNetwork->StopUDPSockets();
 	g_theObserver->Restart();
 
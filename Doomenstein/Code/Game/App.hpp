@@ -25,7 +25,7 @@ public:
 	bool HandleQuitRequisted();
 
 	void StartServer(eGameType gameType, int port);
-	void StartClient(eGameType gameType, std::string const& serverIP, int serverPort);
+	void StartClient(eGameType gameType, std::string const& serverIP, int serverPort, std::string const& replyIP);
 
 	Window* GetWindow() const {return m_theWindow;}
 	Vec2 GetWindowDimensions() const;
@@ -10,11 +10,16 @@
 #include "Game/Projectile.hpp"
 #include "Game/RemoteClient.hpp"
 #include "Game/NetworkObserver.hpp"
+#include "Game/NetTransport.hpp"
 #include "Engine/Network/Network.hpp"
-#include "Engine/Network/TCPServer.hpp"
 #include "Engine/Network/UDPSocket.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Time.hpp"
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -43,15 +48,19 @@ AuthoritativeServer::AuthoritativeServer()
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::SetUpTCPServer(int port)
+// socket only receives, its send address is never used
+void AuthoritativeServer::Listen(int port)
 {
-    TCPServer* server = g_theNetwork->CreateTCPServer((uint16_t)port, NET_NON_BLOCKING);
-    server->m_onNewConnectAccept = MakeCustomClientConnectPackage;
+    m_listenTransport = new UDPTransport(g_theNetwork->CreateUDPSocket("127.0.0.1", port, port));
+    if (!m_listenTransport->IsValid()) {
+        g_theConsole->PrintError(Stringf("Fail to listen on udp port %i", port));
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::BeginFrame()
 {
+    UpdatePendingHandshakes(GetCurrentTimeSeconds());
     for (Client* c : m_clients) {
         c->BeginFrame();
     }
@@ -96,111 +105,254 @@ void AuthoritativeServer::Shutdown()
     delete m_theGame;
     m_theGame = nullptr;
 
+    m_pendingHandshakes.clear();
+    CloseChallengeSockets();
+    if (m_listenTransport) {
+        g_theObserver->ForgetTransport(m_listenTransport);
+        delete m_listenTransport;
+        m_listenTransport = nullptr;
+    }
+
     //TODO delete client here
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::UpdateTCPUDPReference(TCPSocket* client, int toPort, int bindPort)
+// the reply socket is only opened for a response carrying the right token,
+// pawn and baseline wait for it too since it carries the add player
+bool AuthoritativeServer::HandleHandshakePackage(NetTransport* source, std::string_view content)
 {
-    UNUSED(toPort);
+    HandshakeInfo info;
+    if (source == nullptr || source != m_listenTransport || !ParseHandshakePackage(content, info)) {
+        return false;
+    }
 
-    for (Client* c : m_clients) {
-        if (!c->m_isRemote || c->m_udpSocket == nullptr) {
-            continue;
+    double now = GetCurrentTimeSeconds();
+    auto found = m_pendingHandshakes.find(info.nonce);
+    switch (info.step) {
+    case HANDSHAKE_REQUEST:    {
+        if ((int)m_challengeSockets.size() >= HANDSHAKE_MAX_PENDING) {
+            return false;   //request flood within one frame, client retries
+        }
+        if (found != m_pendingHandshakes.end()) {
+            AnswerHandshake(info.nonce, found->second);     //challenge or accept got lost
+            return true;
+        }
+        if ((int)m_pendingHandshakes.size() >= HANDSHAKE_MAX_PENDING) {
+            EvictPendingHandshake();
         }
 
-        UDPSocket* soc = c->m_udpSocket;
-        if (soc->GetBindPort() == bindPort) {
-            c->m_tcpClientSocket = client;
-            return;
+        PendingHandshake& pending = m_pendingHandshakes[info.nonce];
+        pending.replyIP = std::string(info.replyIP);
+        pending.replyPort = info.replyPort;
+        pending.token = RollSecretNumber();
+        pending.expireTime = now + HANDSHAKE_TIMEOUT_SECONDS;
+        AnswerHandshake(info.nonce, pending);
+        return true;
+    }
+    case HANDSHAKE_RESPONSE:    {
+        if (found == m_pendingHandshakes.end() || found->second.token != info.token) {
+            return false;
         }
+
+        PendingHandshake& pending = found->second;
+        if (pending.identifier != 0) {
+            AnswerHandshake(info.nonce, pending);
+            return true;
+        }
+        int bindPort = RollRandomUnusedPort();
+        UDPTransport* transport = new UDPTransport(g_theNetwork->CreateUDPSocket(pending.replyIP, pending.replyPort, bindPort));
+        pending.identifier = RollUnusedIdentifier();
+        AddRemoteClient(transport, pending.identifier, bindPort, pending.replyPort);
+        pending.expireTime = now + HANDSHAKE_TIMEOUT_SECONDS;
+
+        //pawn first so the accept can name it
+        NetMessageHeader addHeader;
+        addHeader.m_type = MESSAGE_ADD_PLAYER;
+        addHeader.m_size = (unsigned short)info.addPlayer.size();
+        HandleUDPMessageOfIdentifier(addHeader, info.addPlayer, pending.identifier);
+        AnswerHandshake(info.nonce, pending);
+        return true;
+    }
+    default:    {
+        return false;
+    }
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::CreateUDPSocket(std::string const& ip, int toPort, int bindPort, int identifier)
+void AuthoritativeServer::AnswerHandshake(unsigned int nonce, PendingHandshake const& pending)
 {
-    RemoteClient* newClient = new RemoteClient();
-    m_clients.push_back(newClient);
-    newClient->m_udpSocket = g_theNetwork->CreateUDPSocket(ip, toPort, bindPort);
-    newClient->m_identifier = identifier;
+    HandshakeInfo answer;
+    answer.nonce = nonce;
+    if (pending.identifier != 0) {
+        Client* c = GetClientOfIdentifier(pending.identifier);
+        answer.step = HANDSHAKE_ACCEPT;
+        answer.identifier = pending.identifier;
+        answer.pawnIndex = c && c->m_playerPawn ? c->m_playerPawn->GetIndex() : -1;
+        if (c && c->m_transport) {
+            g_theObserver->SendPacket(c->m_transport, MakeHandshakePackage(answer), 0.f, true);
+        }
+        return;
+    }
+
+    //engine sockets only send to the peer they were made for, this one lives until next frame
+    //sent right here like a quit before a socket stops, the io thread's queue is left alone
+    ChallengeSocket challenge;
+    challenge.bindPort = RollRandomUnusedPort();
+    challenge.transport = new UDPTransport(g_theNetwork->CreateUDPSocket(pending.replyIP, pending.replyPort, challenge.bindPort));
+    m_challengeSockets.push_back(challenge);
+
+    answer.step = HANDSHAKE_CHALLENGE;
+    answer.token = pending.token;
+    challenge.transport->Send(MakeHandshakePackage(answer));
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::SendOneMessage(std::string const& msg)
+void AuthoritativeServer::UpdatePendingHandshakes(double now)
 {
-    for (Client* c : m_clients) {
-        if (c->m_isRemote && c->m_udpSocket && c->m_udpSocket->IsValid()) {
-            std::string customMsg = msg;
-            NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&customMsg[0]);
-            headerPtr->m_key = c->m_identifier;
-            c->m_udpSocket->SendUDPMessage(customMsg);
+    CloseChallengeSockets();
+    for (auto it = m_pendingHandshakes.begin(); it != m_pendingHandshakes.end();) {
+        if (it->second.expireTime > now) {
+            ++it;
+            continue;
         }
+
+        it = m_pendingHandshakes.erase(it);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string const& content, int identifier, bool reliable)
+// accepted ones only answer repeats so they go first, then the oldest challenge
+void AuthoritativeServer::EvictPendingHandshake()
+{
+    auto evict = m_pendingHandshakes.end();
+    for (auto it = m_pendingHandshakes.begin(); it != m_pendingHandshakes.end(); ++it) {
+        if (evict == m_pendingHandshakes.end()) {
+            evict = it;
+            continue;
+        }
+
+        bool isAccepted = it->second.identifier != 0;
+        bool isEvictAccepted = evict->second.identifier != 0;
+        if (isAccepted != isEvictAccepted ? isAccepted : it->second.expireTime < evict->second.expireTime) {
+            evict = it;
+        }
+    }
+
+    if (evict != m_pendingHandshakes.end()) {
+        m_pendingHandshakes.erase(evict);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void AuthoritativeServer::CloseChallengeSockets()
+{
+    if (m_challengeSockets.empty()) {
+        return;
+    }
+
+    for (ChallengeSocket& challenge : m_challengeSockets) {
+        g_theObserver->ForgetTransport(challenge.transport);
+        delete challenge.transport;
+        ReleaseUsedPort(challenge.bindPort);
+    }
+    m_challengeSockets.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// same protocol path as a udp client, peer end is pumped in process
+RemoteClient* AuthoritativeServer::ConnectLoopbackClient(LoopbackTransport*& peerTransport)
+{
+    LoopbackTransport* serverTransport = nullptr;
+    LoopbackTransport::CreatePair(serverTransport, peerTransport);
+    return AddRemoteClient(serverTransport, RollUnusedIdentifier(), 0, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////
+RemoteClient* AuthoritativeServer::AddRemoteClient(NetTransport* transport, int identifier, int bindPort, int toPort)
+{
+    RemoteClient* newClient = new RemoteClient();
+    m_clients.push_back(newClient);
+    newClient->m_transport = transport;
+    newClient->m_identifier = identifier;
+
+    ClientRoute& route = m_clientRoutes[identifier];
+    route.client = newClient;
+    route.bindPort = bindPort;
+    route.toPort = toPort;
+    m_clientOfTransport[transport] = newClient;
+    return newClient;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void AuthoritativeServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string_view content, int identifier)
 {
     //for individual messages
-    for (Client* c : m_clients) {
-        if (c->m_identifier == identifier) {
-            switch (header.m_type) {
-            case MESSAGE_ADD_PLAYER:
-            {
-                Entity* e = g_theGame->GetEntityOfIndex(identifier);
-                if(e==nullptr || e->GetEntityDefinition()->m_name!="Marine"){
-                    if (e) {
-                        DeleteEntity(e);
-                    }
-                    e = g_theGame->SpawnEntityAtPlayerStart(m_clients.size());
-                    e->SetIndex(identifier);
+    Client* c = GetClientOfIdentifier(identifier);
+    if (c) {
+        switch (header.m_type) {
+        case MESSAGE_ADD_PLAYER:
+        {
+            //pawn keeps the index the game gave it, the key stays out of entity messages
+            Entity* e = c->m_playerPawn;
+            if(e==nullptr || e->GetEntityDefinition()->m_name!="Marine"){
+                if (e) {
+                    DeleteEntity(e);
                 }
-                c->Startup(e,this);
-                break;
+                e = g_theGame->SpawnEntityAtPlayerStart(m_clients.size());
             }
-            case MESSAGE_PLAYER_INPUT:
-            {
-                InputInfo input;
-                if (ParsePlayerInputMessage(content, input)) {
-                    c->m_input = input;
-                }
-                break;
-            }
-            case MESSAGE_ACK:
-            {
-                c->ReceiveACKMessage(content);
-                break;
+            SetClientPawn(c, e);
+            if (c->m_isRemote) {
+                ParseAddPlayerMessage(content, m_remoteTableHashes);
+                c->InsertStringTableMsg(MakeSharedMessage(MakeStringTableMessage(m_stringTables, m_remoteTableHashes)));
+                c->m_baseline.Start(m_theGame->GetEntities(), GetCurrentTimeSeconds());
             }
+            break;
+        }
+        case MESSAGE_STRING_TABLE_ACK:
+        {
+            c->ConfirmStringTable(ParseStringTableAckMessage(content, m_stringTables));
+            break;
+        }
+        case MESSAGE_CLOCK_SYNC_REQUEST:
+        {
+            //answered on next send so hold time is measured
+            if (ParseClockSyncRequestMessage(content, c->m_syncClientSendTime)) {
+                c->m_syncServerReceiveTime = c->m_lastReceiveTime;
+                c->m_hasSyncRequest = true;
             }
-
-            //reliable send immediately
-            if (reliable && c->m_udpSocket && c->m_udpSocket->IsValid()) {
-                std::string ack = MakeReliableACKMessage(header.m_seqNo);
-                std::string pack = MakeTextPackage(ack);
-                NetworkPackageHeader* ptr = reinterpret_cast<NetworkPackageHeader*>(&pack[0]);
-                ptr->m_key = c->m_identifier;
-                c->m_udpSocket->SendUDPMessage(pack);
+            break;
+        }
+        case MESSAGE_PLAYER_INPUT:
+        {
+            if (ParsePlayerInputMessage(content, m_receivedInputs)) {
+                for (InputInfo const& input : m_receivedInputs) {
+                    ReceiveRemoteInput(c, input);
+                }
             }
+            break;
+        }
         }
     }
 
     //for all clients messages
     eNetMessageHeaderType type = (eNetMessageHeaderType)header.m_type;
     if(type==MESSAGE_SOUND_PLAY)    {
-        size_t id = StringConvert(content.c_str(), 0);
-        for (Client* c : m_clients) {
-            c->PlaySoundOnClient(id);
+        size_t id = 0;
+        if (ParseSoundPlayMessage(content, id)) {
+            for (Client* client : m_clients) {
+                client->PlaySoundOnClient(id);
+            }
         }
     }
     else if (type == MESSAGE_ENTITY_TELEPORT) {
         ParseEntityTeleportMessage(content);
     }
     else if (type == MESSAGE_ADD_PLAYER) {
-        for (Client* cl : m_clients) {
-            if (cl->m_playerPawn) {
-                AddEntity(cl->m_playerPawn);
-            }
+        //others learn the new pawn, joiner gets the rest from its baseline
+        Client* joiner = GetClientOfIdentifier(identifier);
+        if (joiner && joiner->m_playerPawn) {
+            AddEntity(joiner->m_playerPawn);
         }
     }
 }
@@ -210,28 +362,48 @@ void AuthoritativeServer::AddPlayer(Client* newClient)
 {
     Entity* entity = m_theGame->SpawnEntityAtPlayerStart(m_clients.size());
     m_clients.push_back(newClient);
-    newClient->Startup(entity, this);
+    m_clientRoutes[newClient->m_identifier].client = newClient;
+    SetClientPawn(newClient, entity);
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::RemovePlayer(Client* client)
+// keeps pawn index and player flag in step with the client's pawn
+void AuthoritativeServer::SetClientPawn(Client* client, Entity* pawn)
 {
-    if(client->m_playerPawn){
-        AddRemoveMessageToClients(client->m_playerPawn->GetIndex());
+    Entity* oldPawn = client->m_playerPawn;
+    if (oldPawn) {
+        oldPawn->SetIsPlayerPawn(false);
+        m_clientOfPawnIndex.erase(oldPawn->GetIndex());
     }
 
-    Server::RemovePlayer(client);
+    client->Startup(pawn, this);
+    if (pawn) {
+        pawn->SetIsPlayerPawn(true);
+        m_clientOfPawnIndex[pawn->GetIndex()] = client;
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void AuthoritativeServer::RemoveTCPClient(TCPSocket* clientSoc)
+void AuthoritativeServer::RemovePlayer(Client* client)
 {
-    for (Client* c : m_clients) {
-        if (c->m_isRemote && c->m_tcpClientSocket == clientSoc) {
-            RemovePlayer(c);
-            return;
-        }
+    if(client->m_playerPawn){
+        AddRemoveMessageToClients(client->m_playerPawn->GetIndex());
+    }
+
+    //late packets with this key are dropped from now on
+    auto found = m_clientRoutes.find(client->m_identifier);
+    if (found != m_clientRoutes.end() && found->second.client == client) {
+        ReleaseUsedPort(found->second.bindPort);    //to port is the client's own
+        m_clientRoutes.erase(found);
+    }
+    if (client->m_transport) {
+        m_clientOfTransport.erase(client->m_transport);
     }
+    if (client->m_playerPawn) {
+        m_clientOfPawnIndex.erase(client->m_playerPawn->GetIndex());
+    }
+
+    Server::RemovePlayer(client);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -243,20 +415,21 @@ void AuthoritativeServer::SwitchPlayerMap(Client* client, std::string const& map
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::AddEntity(Entity* entity)
 {
-    std::string msg = MakeEntityCreateMessage(entity);
+    SharedMessage msg = MakeSharedMessage(MakeEntityCreateMessage(entity));
+    SharedMessage idMsg = MakeSharedMessage(MakeEntityCreateMessage(entity, &m_stringTables));
     g_theObserver->AddEntityTransformUpdate(entity);
-    std::string health;
+    SharedMessage health;
     bool shouldHealth = false;
     if(entity->GetEntityType()==ENTITY_ACTOR){
         Actor* a = (Actor*)entity;
         shouldHealth = true;
-        health = MakeActorHealthMessage(entity->GetIndex(), a->GetHealth());
+        health = MakeSharedMessage(MakeActorHealthMessage(entity->GetIndex(), a->GetHealth()));
     }
     for (Client* c : m_clients) {
         if (c->m_isRemote) {
-            c->InsertCreateMsg(msg);
+            c->InsertCreateMsg(entity->GetIndex(), c->HasStringTable() ? idMsg : msg);
             if(shouldHealth){
-                c->InsertHealthMsg(health);
+                c->InsertHealthMsg(entity->GetIndex(), health);
             }
         }
     }
@@ -265,7 +438,7 @@ void AuthoritativeServer::AddEntity(Entity* entity)
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::DeleteEntity(Entity* entity)
 {
-    if (g_theServer->IsPawnAPlayer(entity)) {
+    if (entity->IsPlayerPawn()) {
         g_theServer->RemovePlayerOfIdentifier(entity->GetIndex());
     }
     else {
@@ -277,9 +450,40 @@ void AuthoritativeServer::DeleteEntity(Entity* entity)
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::ReceiveInputInfo(Client* client)
 {
-    InputInfo& info = client->m_input;
+    //remote inputs come out of the jitter buffer, as many as cover this tick's time
+    if (client->m_isRemote) {
+        client->m_inputBuffer.PopTickInputs(m_tickInputs, (float)m_theGame->GetClock()->GetLastDeltaSeconds());
+        for (InputInfo const& input : m_tickInputs) {
+            client->m_input = input;
+            client->m_lastInputSeq = input.seq;
+            client->m_hasInputSeq = true;
+            ApplyInputInfo(client, input, input.deltaSeconds);
+            if (client->m_isQuiting) {
+                break;
+            }
+        }
+        return;
+    }
+
+    ApplyInputInfo(client, client->m_input, (float)m_theGame->GetClock()->GetLastDeltaSeconds());
+    client->m_input.isFiring = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void AuthoritativeServer::ReceiveRemoteInput(Client* client, InputInfo const& info)
+{
+    if (client->m_isQuiting || client->m_playerPawn == nullptr) {
+        return;
+    }
+
+    client->m_inputBuffer.Insert(info);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void AuthoritativeServer::ApplyInputInfo(Client* client, InputInfo const& info, float deltaSeconds)
+{
     Entity* pawn = client->m_playerPawn;
-    m_theGame->UpdatePlayerForInput(pawn, info);
+    m_theGame->UpdatePlayerForInput(pawn, info, deltaSeconds);
 
     if (info.isFiring && 
         (client->m_isRemote || ((Actor*)client->m_playerPawn)->GetHealth()>0.f)) {
@@ -305,8 +509,6 @@ void AuthoritativeServer::ReceiveInputInfo(Client* client)
     if (info.isClosing) {
         RemovePlayer(client);
     }    
-
-    client->m_input.isFiring=false;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -320,77 +522,80 @@ void AuthoritativeServer::PlayGlobalSound(SoundID id)
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::AddRemoveMessageToClients(int entityIdxToRemove)
 {
-    std::string deleteMsg = MakeEntityDeleteMessage(entityIdxToRemove);
+    SharedMessage deleteMsg = MakeSharedMessage(MakeEntityDeleteMessage(entityIdxToRemove));
+    g_theObserver->RemoveEntityTransformUpdate(entityIdxToRemove);
     for (Client* c : m_clients) {
+        c->m_priority.RemoveEntity(entityIdxToRemove);
         if (!c->m_isRemote || c->m_playerPawn==nullptr) {
             continue;
         }
 
         RemoteClient* remoClient = (RemoteClient*)c;
-        remoClient->InsertDeleteMsg(deleteMsg);
+        remoClient->InsertDeleteMsg(entityIdxToRemove, deleteMsg);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::AddTeleportMessageToClients(Entity* entityToTeleport)
 {
-    std::string teleportMsg = MakeEntityTeleportMessage(entityToTeleport);
+    SharedMessage teleportMsg = MakeSharedMessage(MakeEntityTeleportMessage(entityToTeleport));
+    SharedMessage idTeleportMsg = MakeSharedMessage(MakeEntityTeleportMessage(entityToTeleport, &m_stringTables));
     for (Client* c : m_clients) {
         if (!c->m_isRemote || c->m_playerPawn == nullptr) {
             continue;
         }
 
         RemoteClient* remoClient = (RemoteClient*)c;
-        remoClient->InsertTeleportMsg(teleportMsg);
+        remoClient->InsertTeleportMsg(entityToTeleport->GetIndex(), c->HasStringTable() ? idTeleportMsg : teleportMsg);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
 void AuthoritativeServer::AddHealthMessageToClients(Actor* actorToUpdateHealth)
 {
-    std::string healthMsg = MakeActorHealthMessage(actorToUpdateHealth->GetIndex(), actorToUpdateHealth->GetHealth());
+    SharedMessage healthMsg = MakeSharedMessage(MakeActorHealthMessage(actorToUpdateHealth->GetIndex(), actorToUpdateHealth->GetHealth()));
     for (Client* c : m_clients) {
         if (!c->m_isRemote || c->m_playerPawn == nullptr) {
             continue;
         }
 
         RemoteClient* remoClient = (RemoteClient*)c;
-        remoClient->InsertHealthMsg(healthMsg);
+        remoClient->InsertHealthMsg(actorToUpdateHealth->GetIndex(), healthMsg);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
-Client* AuthoritativeServer::GetClientOfUDPSocket(UDPSocket* soc) const
+Client* AuthoritativeServer::GetClientOfTransport(NetTransport* transport) const
 {
-    for (Client* c : m_clients) {
-        if (c->m_udpSocket == soc) {
-            return c;
-        }
-    }
+    auto found = m_clientOfTransport.find(transport);
+    return found != m_clientOfTransport.end() ? found->second : nullptr;
+}
 
-    return nullptr;
+//////////////////////////////////////////////////////////////////////////
+Client* AuthoritativeServer::GetClientOfIdentifier(int identifier) const
+{
+    auto found = m_clientRoutes.find(identifier);
+    return found != m_clientRoutes.end() ? found->second.client : nullptr;
 }
 
 //////////////////////////////////////////////////////////////////////////
-Client* AuthoritativeServer::GetClientOfPawnIndex(int idx) const
+// udp clients all send to the listen port, their own transports only reply
+// the listen socket gives no source address, so unlike per client transports
+// a key is only as good as it is unguessable
+Client* AuthoritativeServer::GetClientOfPacket(int identifier, NetTransport* transport) const
 {
-    for (Client* c : m_clients) {
-        if (c->m_playerPawn && c->m_playerPawn->GetIndex() == idx) {
-            return c;
-        }
+    if (transport == nullptr || transport != m_listenTransport) {
+        return Server::GetClientOfPacket(identifier, transport);
     }
 
-    return nullptr;
+    auto found = m_clientRoutes.find(identifier);
+    bool isUDPClient = found != m_clientRoutes.end() && found->second.bindPort != 0;
+    return isUDPClient ? found->second.client : nullptr;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool AuthoritativeServer::IsPawnAPlayer(Entity* pawn) const
+Client* AuthoritativeServer::GetClientOfPawnIndex(int idx) const
 {
-    for (Client* c : m_clients) {
-        if (c->m_playerPawn == pawn) {
-            return true;
-        }
-    }
-
-    return false;
+    auto found = m_clientOfPawnIndex.find(idx);
+    return found != m_clientOfPawnIndex.end() ? found->second : nullptr;
 }
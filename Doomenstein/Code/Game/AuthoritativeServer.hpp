@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Game/Server.hpp"
+#include <unordered_map>
 
-class TCPServer;
-class TCPSocket;
 class Actor;
+class RemoteClient;
+class LoopbackTransport;
+class UDPTransport;
+struct HandshakeInfo;
 
 // actually run the game
 class AuthoritativeServer : public Server
@@ -12,35 +15,79 @@ class AuthoritativeServer : public Server
 public:
     AuthoritativeServer();
 
-    void SetUpTCPServer(int port);
+    void Listen(int port);
 
     void BeginFrame() override;  
     void Update()override;
     void Render() const override;
     void Shutdown() override;
 
-    void UpdateTCPUDPReference(TCPSocket* client, int toPort, int bindPort);
-    void CreateUDPSocket(std::string const& ip, int toPort, int bindPort, int identifier) override;
-    void SendOneMessage(std::string const& msg) override;
-    void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string const& content, int identifier, bool reliable) override;
+    bool HandleHandshakePackage(NetTransport* source, std::string_view content) override;
+    RemoteClient* ConnectLoopbackClient(LoopbackTransport*& peerTransport);
+    void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string_view content, int identifier) override;
 
     void AddPlayer(Client* newClient) override;
     void RemovePlayer(Client* client) override;
-    void RemoveTCPClient(TCPSocket* clientSoc);
     void SwitchPlayerMap(Client* client, std::string const& mapName) override;
 
     void AddEntity(Entity* entity);
     void DeleteEntity(Entity* entity);
     void ReceiveInputInfo(Client* client) override;
+    void ReceiveRemoteInput(Client* client, InputInfo const& info);
     void PlayGlobalSound(SoundID id) override;
     void AddRemoveMessageToClients(int entityIdxToRemove);
     void AddTeleportMessageToClients(Entity* entityToTeleport);
     void AddHealthMessageToClients(Actor* actorToUpdateHealth);
 
-    Client* GetClientOfUDPSocket(UDPSocket* soc) const override;
+    Client* GetClientOfTransport(NetTransport* transport) const override;
+    Client* GetClientOfIdentifier(int identifier) const override;
+    Client* GetClientOfPacket(int identifier, NetTransport* transport) const override;
     Client* GetClientOfPawnIndex(int idx) const override;
-    bool IsPawnAPlayer(Entity* pawn) const override;
 
 private:
-    TCPServer* m_tcpServer = nullptr;
+    //demux of the shared listen socket: key to client, replies leave on the client's own
+    //socket since engine sockets send to one fixed peer, ports go back to the pool on removal
+    struct ClientRoute
+    {
+        Client* client = nullptr;
+        int bindPort = 0;
+        int toPort = 0;
+    };
+
+    //answered challenge waits for its response, accepted one stays to answer repeats
+    //nothing but the reply address is held before the token comes back
+    struct PendingHandshake
+    {
+        std::string replyIP;
+        int replyPort = 0;
+        unsigned int token = 0;
+        int identifier = 0;
+        double expireTime = 0.0;
+    };
+
+    //socket a challenge went out on, closed next frame
+    struct ChallengeSocket
+    {
+        UDPTransport* transport = nullptr;
+        int bindPort = 0;
+    };
+
+    void ApplyInputInfo(Client* client, InputInfo const& info, float deltaSeconds);
+    void SetClientPawn(Client* client, Entity* pawn);
+    RemoteClient* AddRemoteClient(NetTransport* transport, int identifier, int bindPort, int toPort);
+    void AnswerHandshake(unsigned int nonce, PendingHandshake const& pending);
+    void UpdatePendingHandshakes(double now);
+    void EvictPendingHandshake();
+    void CloseChallengeSockets();
+
+private:
+    UDPTransport* m_listenTransport = nullptr;     //the one receive socket of every udp client
+    std::vector<InputInfo> m_receivedInputs;
+    std::vector<InputInfo> m_tickInputs;
+    std::vector<unsigned int> m_remoteTableHashes;
+    std::unordered_map<int, ClientRoute> m_clientRoutes;    //by packet key
+    std::unordered_map<NetTransport*, Client*> m_clientOfTransport;
+    std::unordered_map<int, Client*> m_clientOfPawnIndex;
+    std::unordered_map<unsigned int, PendingHandshake> m_pendingHandshakes;    //by client nonce
+    std::vector<ChallengeSocket> m_challengeSockets;
 };
\ No newline at end of file
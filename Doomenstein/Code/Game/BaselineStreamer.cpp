@@ -0,0 +1,109 @@
+#include "Game/BaselineStreamer.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/Entity.hpp"
+#include "Game/NetConnection.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/ReliableMessageStore.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+// projectiles are short lived and left out
+void BaselineStreamer::Start(std::vector<Entity*> const& entities, double now)
+{
+    m_pendingIndices.clear();
+    for (Entity const* e : entities) {
+        if (e && e->GetEntityType() != ENTITY_PROJECTILE) {
+            m_pendingIndices.push_back(e->GetIndex());
+        }
+    }
+
+    m_nextPending = 0;
+    m_inFlight.clear();
+    m_inFlightBytes = 0;
+    m_isStreaming = true;
+    m_isReady = false;
+    m_stats = BaselineStats();
+    m_stats.startTime = now;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// chunks gone from reliable store are acked, ready once all are
+void BaselineStreamer::Update(ReliableMessageStore const& reliableMsgs, double now)
+{
+    if (!m_isStreaming) {
+        return;
+    }
+
+    for (size_t i = 0; i < m_inFlight.size();) {
+        if (reliableMsgs.Contains(MESSAGE_ENTITY_BASELINE, m_inFlight[i].chunkIdx)) {
+            i++;
+            continue;
+        }
+
+        m_inFlightBytes -= m_inFlight[i].bytes;
+        m_inFlight[i] = m_inFlight.back();
+        m_inFlight.pop_back();
+    }
+
+    if (m_inFlight.empty() && m_nextPending >= m_pendingIndices.size()) {
+        m_isStreaming = false;
+        m_isReady = true;
+        m_stats.readyTime = now;
+        m_pendingIndices.clear();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// return false if window is full or nothing left
+bool BaselineStreamer::MakeNextChunk(int windowBytes, NetStringTables const* tables, std::string& chunk, int& chunkIdx)
+{
+    if (!m_isStreaming || m_inFlightBytes >= windowBytes) {
+        return false;
+    }
+
+    //a chunk always fits one packet
+    int maxChunkBytes = PACKET_MAX_CONTENT_LEN - MESSAGE_HEADER_LEN;
+    m_records.clear();
+    while (m_nextPending < m_pendingIndices.size()) {
+        Entity const* e = g_theGame->GetEntityOfIndex(m_pendingIndices[m_nextPending]);
+        if (e == nullptr) {
+            m_nextPending++;
+            continue;
+        }
+
+        std::string record = MakeEntityBaselineRecord(e, tables);
+        int newSize = (int)(m_records.size() + record.size()) + (m_records.empty() ? 0 : 1);
+        if (!m_records.empty() && newSize > maxChunkBytes) {
+            break;
+        }
+
+        if (!m_records.empty()) {
+            m_records += '|';
+        }
+        m_records += record;
+        m_nextPending++;
+        m_stats.entityCount++;
+    }
+
+    if (m_records.empty()) {
+        return false;
+    }
+
+    chunk = MakeEntityBaselineMessage(m_records);
+    chunkIdx = m_stats.chunkCount++;
+
+    InFlightChunk inFlight;
+    inFlight.chunkIdx = chunkIdx;
+    inFlight.bytes = (int)chunk.size();
+    m_inFlight.push_back(inFlight);
+    m_inFlightBytes += inFlight.bytes;
+    m_stats.sentBytes += inFlight.bytes;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void BaselineStreamer::RecordBurst(int bytes, int packets)
+{
+    m_stats.peakBurstBytes = bytes > m_stats.peakBurstBytes ? bytes : m_stats.peakBurstBytes;
+    m_stats.peakBurstPackets = packets > m_stats.peakBurstPackets ? packets : m_stats.peakBurstPackets;
+}
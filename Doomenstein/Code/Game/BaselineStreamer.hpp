@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Entity;
+class ReliableMessageStore;
+class NetStringTables;
+
+constexpr int BASELINE_MIN_WINDOW_SENDS = 4;    //sends worth of unacked chunks allowed, more when rtt spans more sends
+
+//////////////////////////////////////////////////////////////////////////
+struct BaselineStats
+{
+    int entityCount = 0;
+    int chunkCount = 0;
+    int sentBytes = 0;
+    int peakBurstBytes = 0;     //most bytes sent in one send while joining
+    int peakBurstPackets = 0;
+    double startTime = 0.0;
+    double readyTime = 0.0;
+};
+
+// server side full world snapshot for a joining client, sent as reliable chunks
+// with new chunk bytes per send and unacked chunk bytes capped so a join never bursts
+class BaselineStreamer
+{
+public:
+    void Start(std::vector<Entity*> const& entities, double now);
+    void Update(ReliableMessageStore const& reliableMsgs, double now);
+    bool MakeNextChunk(int windowBytes, NetStringTables const* tables, std::string& chunk, int& chunkIdx);
+    void RecordBurst(int bytes, int packets);
+
+    bool IsStreaming() const {return m_isStreaming;}
+    bool IsReady() const {return m_isReady;}
+    int GetInFlightBytes() const {return m_inFlightBytes;}
+    BaselineStats const& GetStats() const {return m_stats;}
+
+private:
+    struct InFlightChunk
+    {
+        int chunkIdx = 0;
+        int bytes = 0;
+    };
+
+    std::vector<int> m_pendingIndices;      //entities not yet put in a chunk
+    size_t m_nextPending = 0;
+    std::vector<InFlightChunk> m_inFlight;
+    int m_inFlightBytes = 0;
+    std::string m_records;
+
+    bool m_isStreaming = false;
+    bool m_isReady = false;
+    BaselineStats m_stats;
+};
\ No newline at end of file
@@ -4,10 +4,16 @@
 #include "Game/RemoteClient.hpp"
 #include "Game/PlayerClient.hpp"
 #include "Game/NetworkObserver.hpp"
-#include "Engine/Network/UDPSocket.hpp"
+#include "Game/NetCompression.hpp"
+#include "Game/NetIOThread.hpp"
+#include "Game/NetTransport.hpp"
 #include "Engine/Network/Network.hpp"
-#include "Engine/Network/TCPSocket.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/DevConsole.hpp"
+
+#include <cmath>
+#include <cstring>
 
 //////////////////////////////////////////////////////////////////////////
 Client* Client::StartClientWithBool(bool isPlayerClient)
@@ -22,167 +28,332 @@ Client* Client::StartClientWithBool(bool isPlayerClient)
 
 //////////////////////////////////////////////////////////////////////////
 void Client::Shutdown()
-{    
-    std::string quitMsg = MakeClientQuitPackage();
-    NetworkPackageHeader* head = reinterpret_cast<NetworkPackageHeader*>(&quitMsg[0]);
-    head->m_key = m_identifier;
-
-    if (m_tcpClientSocket) {
-        m_tcpClientSocket->Send(quitMsg.data(), quitMsg.size());
-        m_tcpClientSocket->Shutdown();
+{
+    //remote clients tell their peer in RemoteClient::Shutdown
+    if (!m_isRemote && m_transport && m_transport->IsValid()) {
+        g_theNetIO->QueuePacket(m_transport, MakeQuitPackage());
     }
 
-    if (m_udpSocket) {
-        if (m_udpSocket->IsValid()) {
-            g_theNetwork->StopUDPSocket(m_udpSocket->GetBindPort());
-        }
-        m_udpSocket = nullptr;
+    if (m_transport) {
+        g_theNetIO->Flush();
+        g_theObserver->ForgetTransport(m_transport);
+        delete m_transport;
+        m_transport = nullptr;
     }
     m_isQuiting = true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::SendReliableMessages()
+// queue shared messages every frame, send at own adapted rate:
+// reliable first, then shared, then prioritized transforms
+void Client::SendMessages(std::vector<SharedMessage> const& msgs)
 {
-    if (m_udpSocket == nullptr || !m_udpSocket->IsValid() || m_reliableMsgs.empty()) {
+    if (m_transport == nullptr || !m_transport->IsValid()) {
         return;
     }
 
-    std::queue<std::string> packages;
-    PackUpMessages(m_reliableMsgs, packages, true);
-    while (!packages.empty()) {
-        std::string pack = packages.front();
-        NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&pack[0]);
-        headerPtr->m_key = m_identifier;
-        m_udpSocket->SendUDPMessage(pack);
-        packages.pop();
+    m_pendingMsgs.insert(m_pendingMsgs.end(), msgs.begin(), msgs.end());
+
+    double now = GetCurrentTimeSeconds();
+    m_metrics.Update(now);
+    float sendInterval = 1.f / m_sendRate.GetSendRate();
+    if (m_lastSendCheckTime > 0.0) {
+        m_secondsSinceSend += (float)(now - m_lastSendCheckTime);
+    }
+    else {
+        //first send at own phase of the interval so clients don't all send on the same frame
+        m_secondsSinceSend = (1.f - g_theObserver->GetPacer().GetPhase(m_transport)) * sendInterval;
+    }
+    m_lastSendCheckTime = now;
+
+    if (m_secondsSinceSend < sendInterval) {
+        return;
+    }
+
+    float deltaSeconds = m_secondsSinceSend;
+    m_secondsSinceSend -= sendInterval;
+    if (m_secondsSinceSend > sendInterval) {
+        m_secondsSinceSend = 0.f;
+    }
+    m_sendRate.Update(m_connection.GetStats(), deltaSeconds);
+    m_sendBudgetBytes = m_sendRate.GetByteBudget();
+
+    m_packetsThisSend = 0;
+    m_bytesThisSend = 0;
+    if (m_sendBuffer.empty()) {
+        m_sendBuffer.reserve(NET_HEADER_LEN + NET_MAX_DATA_LEN);
+        m_sendBuffer.resize(PACKET_PREFIX_LEN);
+    }
+
+    bool isJoining = m_baseline.IsStreaming();
+    int baselineBytes = isJoining ? StreamBaseline(now) : 0;
+
+    //unacked reliables go out again once a resend timeout passed without their ack
+    m_metrics.SampleReliableBacklog((int)m_reliableMsgs.GetSize());
+    m_reliableMsgs.UpdateFragmentResends(now);
+    double resendTimeout = (double)m_connection.GetResendTimeout();
+    for (ReliableMessage const& reliableMsg : m_reliableMsgs.GetMessages()) {
+        if (!reliableMsg.isAcked && (reliableMsg.sendCount == 0 || now - reliableMsg.lastSendTime >= resendTimeout)) {
+            //before the first ack every send repeats unacked ones, those and group repeats are not losses
+            bool isRetransmit = reliableMsg.sendCount > 0 && resendTimeout > 0.0 && !reliableMsg.isGroupRepeat;
+            AppendReliableToPacket(reliableMsg, now, isRetransmit);
+        }
+    }
+
+    //owner reconciles own pawn against this instead of transforms
+    if (m_isRemote && m_hasInputSeq && m_playerPawn) {
+        AppendToPacket(MakePlayerStateMessage(m_playerPawn, m_lastInputSeq));
+    }
+
+    //clock sync, answer stamped as late as possible
+    if (m_hasSyncRequest) {
+        AppendToPacket(MakeClockSyncResponseMessage(m_syncClientSendTime, m_syncServerReceiveTime, GetCurrentTimeSeconds()));
+        m_hasSyncRequest = false;
+        m_isPacketTimeCritical = true;
+    }
+    if (!g_theServer->m_isAuthoritative && m_clockSync.ShouldRequest(now)) {
+        AppendToPacket(MakeClockSyncRequestMessage(GetCurrentTimeSeconds()));
+        m_isPacketTimeCritical = true;
+    }
+
+    //unacked inputs ride on the next few packets so losses cost no input
+    if (m_predictor.GetPendingCount() > 0) {
+        m_predictor.GetRedundantInputs(m_redundantInputs, MAX_REDUNDANT_INPUTS);
+        AppendInputMessages();
+        m_predictor.RecordSend();
+    }
+
+    for (SharedMessage const& msg : m_pendingMsgs) {
+        AppendToPacket(*msg);
+    }
+    m_pendingMsgs.clear();
+
+    m_priority.Accumulate(m_playerPawn, deltaSeconds);
+    std::vector<std::string> transformMsgs;
+    int transformBudget = m_sendBudgetBytes - baselineBytes;
+    m_priority.GatherMessages(transformMsgs, transformBudget > 0 ? transformBudget : 0);
+    for (std::string const& msg : transformMsgs) {
+        AppendToPacket(msg);
+    }
+
+    //always send one packet so remote gets acks
+    if (HasPendingPacket() || m_packetsThisSend == 0) {
+        FlushPacket();
+    }
+
+    if (isJoining) {
+        m_baseline.RecordBurst(m_bytesThisSend, m_packetsThisSend);
+        if (m_baseline.IsReady()) {
+            BaselineStats const& stats = m_baseline.GetStats();
+            g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i ready: %i entities in %i chunks (%i bytes), joined in %.0fms, peak burst %i bytes in %i packets",
+                m_identifier, stats.entityCount, stats.chunkCount, stats.sentBytes, (stats.readyTime - stats.startTime) * 1000.0,
+                stats.peakBurstBytes, stats.peakBurstPackets));
+        }
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::InsertDeleteMsg(std::string const& deleteMsg)
+// return false if packet is a duplicate and should be dropped
+bool Client::ReceivePacketHeader(NetPacketHeader const& header, double receiveTime)
 {
-    if (GetHeaderTypeForMessage(deleteMsg) != MESSAGE_ENTITY_DELETE) {
-        return;
+    std::vector<unsigned short> ackedIds;
+    bool isNew = m_connection.ReceivePacketHeader(header, receiveTime, ackedIds);
+    m_lastReceiveTime = receiveTime;
+    if (!g_theServer->m_isAuthoritative && header.m_serverTick > g_theServer->m_tick) {
+        g_theServer->m_tick = header.m_serverTick;
     }
+    for (unsigned short id : ackedIds) {
+        m_reliableMsgs.Acknowledge(id);
+    }
+    return isNew;
+}
 
-    unsigned short seqNo = GetSeqNoForMessage(deleteMsg);
-    int entityIdx = GetEntityIdxFromOneTrunkMessage(deleteMsg);
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertDeleteMsg(int entityIdx, SharedMessage const& deleteMsg)
+{
+    InsertReliableMsg(MESSAGE_ENTITY_DELETE, entityIdx, deleteMsg, false);
+}
 
-    for (std::string const& str : m_reliableMsgs) {
-        if (GetSeqNoForMessage(str) == seqNo ||
-            (GetHeaderTypeForMessage(str)==MESSAGE_ENTITY_DELETE && 
-            GetEntityIdxFromOneTrunkMessage(str) == entityIdx)) {
-            return;
-        }
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertHealthMsg(int entityIdx, SharedMessage const& healthMsg)
+{
+    InsertReliableMsg(MESSAGE_ACTOR_HEALTH, entityIdx, healthMsg, true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertTeleportMsg(int entityIdx, SharedMessage const& teleportMsg)
+{
+    InsertReliableMsg(MESSAGE_ENTITY_TELEPORT, entityIdx, teleportMsg, true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertCreateMsg(int entityIdx, SharedMessage const& createMsg)
+{
+    InsertReliableMsg(MESSAGE_ENTITY_CREATE, entityIdx, createMsg, true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// server side, ids only used once remote confirms the table hashes
+void Client::InsertStringTableMsg(SharedMessage const& tableMsg)
+{
+    InsertReliableMsg(MESSAGE_STRING_TABLE, 0, tableMsg, true);
+    m_isStringTableConfirmed = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertStringTableAckMsg(SharedMessage const& ackMsg)
+{
+    InsertReliableMsg(MESSAGE_STRING_TABLE_ACK, 0, ackMsg, true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// this connection only, dropped while it has no transport like shared messages
+void Client::QueueMessage(SharedMessage const& msg)
+{
+    if (m_transport != nullptr && m_transport->IsValid()) {
+        m_pendingMsgs.push_back(msg);
     }
-    m_reliableMsgs.push_back(deleteMsg);
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::InsertHealthMsg(std::string const& healthMsg)
+std::string Client::MakeQuitPackage() const
+{
+    std::string header = MakeClientQuitPackage();
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&header[0]);
+    headerPtr->m_key = m_identifier;
+    return header;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void Client::InsertReliableMsg(eNetMessageHeaderType type, int entityIdx, SharedMessage const& msg, bool supersede)
 {
-    if (GetHeaderTypeForMessage(healthMsg) != MESSAGE_ACTOR_HEALTH) {
+    if (!supersede && m_reliableMsgs.Contains(type, entityIdx)) {
         return;
     }
 
-    unsigned short seqNo = GetSeqNoForMessage(healthMsg);
-    int entityIdx = GetEntityIdxFromTwoChunksMessage(healthMsg);
-
-    //delete outdated health msg
-    for (size_t i = 0; i < m_reliableMsgs.size();) {
-        std::string const& str = m_reliableMsgs[i];
-        if (GetSeqNoForMessage(str) == seqNo ||
-            (GetHeaderTypeForMessage(str)==MESSAGE_ACTOR_HEALTH && 
-            GetEntityIdxFromTwoChunksMessage(str) == entityIdx)) {
-            m_reliableMsgs.erase(m_reliableMsgs.begin()+i);
-        }
-        else {
-            i++;
+    //each fragment acked on its own, group stays stored as a whole so supersede replaces all of it
+    if (IsMessageOversized(*msg)) {
+        unsigned short group = m_nextFragmentGroup++;
+        if (MakeFragmentMessages(*msg, group, m_fragmentMsgs)) {
+            m_fragmentIds.clear();
+            for (size_t i = 0; i < m_fragmentMsgs.size(); i++) {
+                m_fragmentIds.push_back(m_connection.GetNextReliableId());
+            }
+            m_reliableMsgs.InsertFragments(type, entityIdx, group, m_fragmentMsgs, m_fragmentIds, supersede);
+            m_fragmentedSends++;
         }
+        return;
     }
 
-    m_reliableMsgs.push_back(healthMsg);
+    unsigned short id = m_connection.GetNextReliableId();
+    m_reliableMsgs.Insert(type, entityIdx, msg, id, supersede);
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::InsertTeleportMsg(std::string const& teleportMsg)
+void Client::AppendToPacket(std::string const& msg)
 {
-    eNetMessageHeaderType type = GetHeaderTypeForMessage(teleportMsg);
-    if (type != MESSAGE_ENTITY_TELEPORT) {
+    if (IsMessageOversized(msg)) {
+        AppendFragmentsToPacket(msg);
         return;
     }
 
-    unsigned short seqNo = GetSeqNoForMessage(teleportMsg);
-    int entityIdx = GetEntityIdxFromTwoChunksMessage(teleportMsg);
+    if (HasPendingPacket() && m_sendBuffer.size() + msg.size() > NET_HEADER_LEN + NET_MAX_DATA_LEN) {
+        FlushPacket();
+    }
 
-    //delete old teleport
-    for (size_t i = 0; i < m_reliableMsgs.size();) {
-        std::string const& str = m_reliableMsgs[i];
-        if (GetSeqNoForMessage(str) == seqNo ||
-            (GetHeaderTypeForMessage(str) == type && 
-            GetEntityIdxFromTwoChunksMessage(str) == entityIdx)) {
-            m_reliableMsgs.erase(m_reliableMsgs.begin() + i);
-        }
-        else {
-            i++;
-        }
+    m_metrics.RecordSentMessage(GetHeaderTypeForMessage(msg), (int)msg.size());
+    m_sendBuffer += msg;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// each message stands alone with its own first seq, so a long window is split instead of fragmented
+void Client::AppendInputMessages()
+{
+    for (size_t first = 0; first < m_redundantInputs.size(); first += MAX_INPUTS_PER_MESSAGE) {
+        size_t last = first + MAX_INPUTS_PER_MESSAGE < m_redundantInputs.size() ? first + MAX_INPUTS_PER_MESSAGE : m_redundantInputs.size();
+        m_messageInputs.assign(m_redundantInputs.begin() + first, m_redundantInputs.begin() + last);
+        AppendToPacket(MakePlayerInputMessage(m_messageInputs));
     }
+}
 
-    m_reliableMsgs.push_back(teleportMsg);
+//////////////////////////////////////////////////////////////////////////
+void Client::AppendReliableToPacket(ReliableMessage const& reliableMsg, double now, bool isRetransmit)
+{
+    m_reliableMsgs.MarkSent(reliableMsg.id, now);
+    if (isRetransmit) {
+        m_metrics.RecordRetransmit();
+    }
+    AppendToPacket(*reliableMsg.msg);
+    m_curReliableIds.push_back(reliableMsg.id);
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::InsertCreateMsg(std::string const& createMsg)
+void Client::AppendFragmentsToPacket(std::string const& msg)
 {
-    eNetMessageHeaderType type = GetHeaderTypeForMessage(createMsg);
-    if (type != MESSAGE_ENTITY_CREATE) {
+    if (!MakeFragmentMessages(msg, m_nextFragmentGroup++, m_fragmentMsgs)) {
         return;
     }
 
-    unsigned short seqNo = GetSeqNoForMessage(createMsg);
-    int idx =0;
-    std::string typeName;
-    GetEntityCreateInfoFromMessage(createMsg, idx, typeName);
-
-    //delete old create
-    for (size_t i = 0; i < m_reliableMsgs.size();) {
-        std::string const& str = m_reliableMsgs[i];
-        int index=0;
-        std::string thisName;
-        GetEntityCreateInfoFromMessage(str, index, thisName);
-        if ((GetHeaderTypeForMessage(str) == type && index == idx && typeName == thisName)
-            || GetSeqNoForMessage(str) == seqNo) {
-            m_reliableMsgs.erase(m_reliableMsgs.begin() + i);
-        }
-        else {
-            i++;
-        }
+    for (std::string const& fragment : m_fragmentMsgs) {
+        AppendToPacket(fragment);
     }
-
-    m_reliableMsgs.push_back(createMsg);
+    m_fragmentedSends++;
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Client::ReceiveACKMessage(std::string const& content)
+// new chunks take at most half of each send, unacked ones may span a round trip of sends
+// so the join is not one chunk per rtt, returns bytes of new chunks
+int Client::StreamBaseline(double now)
 {
-    unsigned short seqNo = (unsigned short)StringConvert(content.c_str(), 0u);
-    for (size_t i = 0; i < m_reliableMsgs.size();) {
-        std::string const& str = m_reliableMsgs[i];
-        if (GetSeqNoForMessage(str) == seqNo) {
-            m_reliableMsgs.erase(m_reliableMsgs.begin()+i);
-        }
-        else {
-            i++;
-        }
+    m_baseline.Update(m_reliableMsgs, now);
+
+    int sendBytes = m_sendBudgetBytes / 2;
+    int sendsPerRtt = (int)ceilf(m_connection.GetStats().rtt * m_sendRate.GetSendRate());
+    int windowSends = sendsPerRtt + 1 > BASELINE_MIN_WINDOW_SENDS ? sendsPerRtt + 1 : BASELINE_MIN_WINDOW_SENDS;
+    int windowBytes = sendBytes * windowSends;
+
+    int newBytes = 0;
+    int chunkIdx = 0;
+    NetStringTables const* tables = HasStringTable() ? &g_theServer->m_stringTables : nullptr;
+    while (newBytes < sendBytes && m_baseline.MakeNextChunk(windowBytes, tables, m_baselineChunk, chunkIdx)) {
+        newBytes += (int)m_baselineChunk.size();
+        InsertReliableMsg(MESSAGE_ENTITY_BASELINE, chunkIdx, MakeSharedMessage(std::move(m_baselineChunk)), false);
     }
+    return newBytes;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string Client::MakeQuitPackage() const
+void Client::FlushPacket()
 {
-    std::string header = MakeClientQuitPackage();
-    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&header[0]);
+    //messages after packet header swapped for their compressed form when smaller
+    char const* content = &m_sendBuffer[PACKET_PREFIX_LEN];
+    size_t contentLen = m_sendBuffer.size() - PACKET_PREFIX_LEN;
+    CapturePacketContent(content, contentLen);
+    bool isCompressed = g_compressPackets && CompressPacketContent(content, contentLen, m_compressBuffer);
+    if (isCompressed) {
+        m_sendBuffer.resize(PACKET_PREFIX_LEN);
+        m_sendBuffer += m_compressBuffer;
+    }
+
+    //gather into one buffer, only headers differ per client
+    std::string packHeader = MakeTextPackage(std::string(), !m_curReliableIds.empty());
+    memcpy(&m_sendBuffer[0], packHeader.data(), NET_HEADER_LEN);
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&m_sendBuffer[0]);
     headerPtr->m_key = m_identifier;
-    return header;
+    headerPtr->m_size = (uint16_t)(m_sendBuffer.size() - NET_HEADER_LEN);
+    NetPacketHeader* packetHeader = reinterpret_cast<NetPacketHeader*>(&m_sendBuffer[NET_HEADER_LEN]);
+    //paced first so the rtt send time is when it really leaves
+    float bytesPerSec = (float)m_sendBudgetBytes * m_sendRate.GetSendRate();
+    double sendTime = g_theObserver->SchedulePacket(m_transport, (int)m_sendBuffer.size(), bytesPerSec, m_isPacketTimeCritical);
+    m_connection.WritePacketHeader(m_curReliableIds, sendTime, *packetHeader);
+    packetHeader->m_serverTick = g_theServer->m_tick;
+    packetHeader->m_flags = isCompressed ? PACKET_FLAG_COMPRESSED : 0;
+    g_theObserver->QueuePacket(m_transport, m_sendBuffer, sendTime);
+    m_isPacketTimeCritical = false;
+    m_bytesThisSend += (int)m_sendBuffer.size();
+    m_metrics.RecordSentPacket((int)m_sendBuffer.size());
+
+    m_sendBuffer.resize(PACKET_PREFIX_LEN);
+    m_curReliableIds.clear();
+    m_packetsThisSend++;
 }
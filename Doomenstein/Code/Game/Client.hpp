@@ -3,11 +3,20 @@
 #include <string>
 #include <vector>
 #include "Game/GameCommon.hpp"
+#include "Game/PriorityAccumulator.hpp"
+#include "Game/NetConnection.hpp"
+#include "Game/ConnectionMetrics.hpp"
+#include "Game/ReliableMessageStore.hpp"
+#include "Game/InputPredictor.hpp"
+#include "Game/InputJitterBuffer.hpp"
+#include "Game/SendRateController.hpp"
+#include "Game/ClockSync.hpp"
+#include "Game/MessageFragmenter.hpp"
+#include "Game/BaselineStreamer.hpp"
 
 class Entity;
 class Server;
-class UDPSocket;
-class TCPSocket;
+class NetTransport;
 typedef size_t SoundID;
 
 class Client
@@ -23,17 +32,32 @@ public:
     virtual void EndFrame() = 0;
     virtual void Shutdown();
 
-    virtual void SendReliableMessages();
-    virtual void InsertDeleteMsg(std::string const& deleteMsg);
-    virtual void InsertHealthMsg(std::string const& healthMsg);
-    virtual void InsertTeleportMsg(std::string const& teleportMsg);
-    virtual void InsertCreateMsg(std::string const& createMsg);
-    virtual void ReceiveACKMessage(std::string const& content);
+    virtual void SendMessages(std::vector<SharedMessage> const& msgs);
+    virtual bool ReceivePacketHeader(NetPacketHeader const& header, double receiveTime);
+    virtual void InsertDeleteMsg(int entityIdx, SharedMessage const& deleteMsg);
+    virtual void InsertHealthMsg(int entityIdx, SharedMessage const& healthMsg);
+    virtual void InsertTeleportMsg(int entityIdx, SharedMessage const& teleportMsg);
+    virtual void InsertCreateMsg(int entityIdx, SharedMessage const& createMsg);
+    void InsertStringTableMsg(SharedMessage const& tableMsg);
+    void InsertStringTableAckMsg(SharedMessage const& ackMsg);
+    void ConfirmStringTable(bool isMatching) {m_isStringTableConfirmed = isMatching;}
+    bool HasStringTable() const {return m_isStringTableConfirmed;}
+    void QueueMessage(SharedMessage const& msg);
     virtual bool PlaySoundOnClient(size_t id) = 0;
 
     virtual bool CouldUpdateInput() const = 0;
     std::string MakeQuitPackage() const;
 
+protected:
+    void InsertReliableMsg(eNetMessageHeaderType type, int entityIdx, SharedMessage const& msg, bool supersede);
+    void AppendToPacket(std::string const& msg);
+    void AppendReliableToPacket(ReliableMessage const& reliableMsg, double now, bool isRetransmit);
+    void AppendFragmentsToPacket(std::string const& msg);
+    void AppendInputMessages();
+    int StreamBaseline(double now);
+    bool HasPendingPacket() const {return m_sendBuffer.size() > PACKET_PREFIX_LEN;}
+    void FlushPacket();
+
 public:
     bool m_isQuiting = false;
     bool m_isRemote = false;
@@ -41,11 +65,46 @@ public:
     Server* m_server = nullptr;
 
     InputInfo m_input;
-    bool m_shot = false;
+    InputPredictor m_predictor;         //remote side, own pawn
+    ClockSync m_clockSync;              //remote side, server clock estimate
+    InputJitterBuffer m_inputBuffer;    //server side, remote inputs per tick
+    unsigned short m_lastInputSeq = 0;  //server side, echoed back in player state
+    bool m_hasInputSeq = false;
+    double m_syncClientSendTime = 0.0;      //server side, pending clock sync answer
+    double m_syncServerReceiveTime = 0.0;
+    bool m_hasSyncRequest = false;
+    bool m_isStringTableConfirmed = false;  //server side, remote reported our table hashes
+    double m_lastReceiveTime = 0.0;     //of packet being handled, engine dispatch time taken before any decoding, 0 until one came
 
-    TCPSocket* m_tcpClientSocket = nullptr;
-    UDPSocket* m_udpSocket = nullptr;
+    NetTransport* m_transport = nullptr;    //owned, udp or loopback
     int m_identifier = -1;
 
-    std::vector<std::string> m_reliableMsgs;
+    ReliableMessageStore m_reliableMsgs;
+    NetConnection m_connection;
+    ConnectionMetrics m_metrics;
+
+    BaselineStreamer m_baseline;        //server side, join snapshot
+    FragmentReassembler m_fragments;
+    int m_fragmentedSends = 0;          //oversized messages split on send
+
+    PriorityAccumulator m_priority;
+    SendRateController m_sendRate;
+    int m_sendBudgetBytes = CLIENT_SEND_BUDGET_BYTES;
+
+protected:
+    std::string m_sendBuffer;   //reused, headers written in place in front of messages
+    std::vector<unsigned short> m_curReliableIds;
+    int m_packetsThisSend = 0;
+    bool m_isPacketTimeCritical = false;    //carries clock sync, skips the pacer phase
+    int m_bytesThisSend = 0;
+    std::string m_baselineChunk;
+    std::string m_compressBuffer;
+    std::vector<InputInfo> m_redundantInputs;
+    std::vector<InputInfo> m_messageInputs;
+    std::vector<std::string> m_fragmentMsgs;
+    std::vector<unsigned short> m_fragmentIds;
+    unsigned short m_nextFragmentGroup = 0;
+    std::vector<SharedMessage> m_pendingMsgs;   //queued until this connection's next send
+    double m_lastSendCheckTime = 0.0;
+    float m_secondsSinceSend = 0.f;
 };
@@ -0,0 +1,59 @@
+#include "Game/ClockSync.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+void ClockSync::Reset()
+{
+    m_sampleCount = 0;
+    m_nextSample = 0;
+    m_requestCount = 0;
+    m_lastRequestTime = 0.0;
+    m_offset = 0.0;
+    m_delay = 0.0;
+    m_drift = 0.0;
+    m_firstOffset = 0.0;
+    m_firstOffsetTime = 0.0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// quick burst on handshake, then periodic
+bool ClockSync::ShouldRequest(double localTime)
+{
+    double interval = m_requestCount < CLOCK_SYNC_HANDSHAKE_SAMPLES ? 
+        CLOCK_SYNC_HANDSHAKE_INTERVAL_SECONDS : CLOCK_SYNC_INTERVAL_SECONDS;
+    if (m_requestCount > 0 && localTime - m_lastRequestTime < interval) {
+        return false;
+    }
+
+    m_lastRequestTime = localTime;
+    m_requestCount++;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ClockSync::AddSample(double clientSendTime, double serverReceiveTime, double serverSendTime, double clientReceiveTime)
+{
+    ClockSyncSample& sample = m_samples[m_nextSample];
+    sample.offset = ((serverReceiveTime - clientSendTime) + (serverSendTime - clientReceiveTime)) * .5;
+    sample.delay = (clientReceiveTime - clientSendTime) - (serverSendTime - serverReceiveTime);
+    sample.localTime = clientReceiveTime;
+    m_nextSample = (m_nextSample + 1) % CLOCK_SYNC_SAMPLES;
+    m_sampleCount = m_sampleCount < CLOCK_SYNC_SAMPLES ? m_sampleCount + 1 : CLOCK_SYNC_SAMPLES;
+
+    //least delayed sample has least asymmetry error
+    ClockSyncSample const* best = &m_samples[0];
+    for (int i = 1; i < m_sampleCount; i++) {
+        if (m_samples[i].delay < best->delay) {
+            best = &m_samples[i];
+        }
+    }
+    m_offset = best->offset;
+    m_delay = best->delay;
+
+    if (m_sampleCount == 1) {
+        m_firstOffset = m_offset;
+        m_firstOffsetTime = clientReceiveTime;
+    }
+    else if (clientReceiveTime - m_firstOffsetTime > CLOCK_DRIFT_MIN_SECONDS) {
+        m_drift = (m_offset - m_firstOffset) / (clientReceiveTime - m_firstOffsetTime);
+    }
+}
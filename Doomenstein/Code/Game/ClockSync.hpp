@@ -0,0 +1,45 @@
+#pragma once
+
+constexpr int CLOCK_SYNC_SAMPLES = 8;
+constexpr int CLOCK_SYNC_HANDSHAKE_SAMPLES = 4;
+constexpr double CLOCK_SYNC_HANDSHAKE_INTERVAL_SECONDS = .1;
+constexpr double CLOCK_SYNC_INTERVAL_SECONDS = 2.0;
+constexpr double CLOCK_DRIFT_MIN_SECONDS = 10.0;
+
+//////////////////////////////////////////////////////////////////////////
+struct ClockSyncSample
+{
+    double offset = 0.0;        //server time - local time
+    double delay = 0.0;         //round trip minus server hold time
+    double localTime = 0.0;
+};
+
+// ntp style offset estimate of server clock, lowest delay sample of recent ones wins
+class ClockSync
+{
+public:
+    void Reset();
+
+    bool ShouldRequest(double localTime);
+    void AddSample(double clientSendTime, double serverReceiveTime, double serverSendTime, double clientReceiveTime);
+
+    double GetEstimatedServerTime(double localTime) const {return localTime + m_offset;}
+    bool IsSynced() const {return m_sampleCount > 0;}
+    double GetOffset() const {return m_offset;}
+    double GetDelay() const {return m_delay;}
+    double GetDrift() const {return m_drift;}
+    int GetSampleCount() const {return m_sampleCount;}
+
+private:
+    ClockSyncSample m_samples[CLOCK_SYNC_SAMPLES];
+    int m_sampleCount = 0;
+    int m_nextSample = 0;
+    int m_requestCount = 0;
+    double m_lastRequestTime = 0.0;
+
+    double m_offset = 0.0;
+    double m_delay = 0.0;
+    double m_drift = 0.0;       //offset change per second
+    double m_firstOffset = 0.0;
+    double m_firstOffsetTime = 0.0;
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "Game/ConnectionMetrics.hpp"
+#include "Game/NetConnection.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+static float BlendAverage(float average, float sample, bool hasAverage)
+{
+    return hasAverage ? average + (sample - average) * NET_METRICS_EWMA_ALPHA : sample;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ConnectionMetrics::RecordSentPacket(int bytes)
+{
+    m_stats.sentPackets++;
+    m_stats.sentBytes += bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ConnectionMetrics::RecordReceivedPacket(int bytes)
+{
+    m_stats.receivedPackets++;
+    m_stats.receivedBytes += bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ConnectionMetrics::RecordSentMessage(eNetMessageHeaderType type, int bytes)
+{
+    if (type >= NUM_NET_MESSAGE_TYPES) {
+        type = MESSAGE_INVALID;
+    }
+    m_stats.messageTypes[type].sentMessages++;
+    m_stats.messageTypes[type].sentBytes += bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ConnectionMetrics::SampleReliableBacklog(int count)
+{
+    m_stats.reliableBacklog = count;
+    m_stats.avgReliableBacklog = BlendAverage(m_stats.avgReliableBacklog, (float)count, m_hasBacklogSample);
+    m_stats.maxReliableBacklog = count > m_stats.maxReliableBacklog ? count : m_stats.maxReliableBacklog;
+    m_hasBacklogSample = true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// rates only change once a window has passed, first full window seeds the averages
+void ConnectionMetrics::Update(double now)
+{
+    if (m_windowStartTime <= 0.0) {
+        TakeWindowSnapshot(now);
+        return;
+    }
+
+    double seconds = now - m_windowStartTime;
+    if (seconds < NET_METRICS_WINDOW_SECONDS) {
+        return;
+    }
+
+    float scale = (float)(1.0 / seconds);
+    m_stats.sentPacketsPerSec = BlendAverage(m_stats.sentPacketsPerSec, (float)(m_stats.sentPackets - m_windowSentPackets) * scale, m_hasRates);
+    m_stats.sentBytesPerSec = BlendAverage(m_stats.sentBytesPerSec, (float)(m_stats.sentBytes - m_windowSentBytes) * scale, m_hasRates);
+    m_stats.receivedPacketsPerSec = BlendAverage(m_stats.receivedPacketsPerSec, (float)(m_stats.receivedPackets - m_windowReceivedPackets) * scale, m_hasRates);
+    m_stats.receivedBytesPerSec = BlendAverage(m_stats.receivedBytesPerSec, (float)(m_stats.receivedBytes - m_windowReceivedBytes) * scale, m_hasRates);
+    m_stats.retransmitsPerSec = BlendAverage(m_stats.retransmitsPerSec, (float)(m_stats.retransmits - m_windowRetransmits) * scale, m_hasRates);
+    m_hasRates = true;
+    TakeWindowSnapshot(now);
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string ConnectionMetrics::MakeSummary(ConnectionStats const& connection) const
+{
+    return Stringf("rtt %.0fms +-%.0f, loss %.1f%%, out %.0fpps %.1fkbps, in %.0fpps %.1fkbps, backlog %i (avg %.1f, max %i), resend %.1f/s",
+        connection.rtt * 1000.f, connection.rttVar * 1000.f, connection.lossRate * 100.f,
+        m_stats.sentPacketsPerSec, m_stats.sentBytesPerSec * 8.f / 1000.f,
+        m_stats.receivedPacketsPerSec, m_stats.receivedBytesPerSec * 8.f / 1000.f,
+        m_stats.reliableBacklog, m_stats.avgReliableBacklog, m_stats.maxReliableBacklog, m_stats.retransmitsPerSec);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one json object per line, message types only listed once sent
+std::string ConnectionMetrics::MakeJson(int identifier, ConnectionStats const& connection, double now) const
+{
+    std::string json = Stringf("{\"time\":%.3f,\"id\":%i,\"rtt_ms\":%.2f,\"jitter_ms\":%.2f,\"min_rtt_ms\":%.2f,\"loss\":%.4f,",
+        now, identifier, connection.rtt * 1000.f, connection.rttVar * 1000.f, connection.minRtt * 1000.f, connection.lossRate);
+    json += Stringf("\"acked_packets\":%lld,\"lost_packets\":%lld,\"sent_packets\":%lld,\"sent_bytes\":%lld,\"received_packets\":%lld,\"received_bytes\":%lld,",
+        connection.ackedPackets, connection.lostPackets, m_stats.sentPackets, m_stats.sentBytes, m_stats.receivedPackets, m_stats.receivedBytes);
+    json += Stringf("\"pps_out\":%.2f,\"kbps_out\":%.2f,\"pps_in\":%.2f,\"kbps_in\":%.2f,",
+        m_stats.sentPacketsPerSec, m_stats.sentBytesPerSec * 8.f / 1000.f, m_stats.receivedPacketsPerSec, m_stats.receivedBytesPerSec * 8.f / 1000.f);
+    json += Stringf("\"retransmits\":%lld,\"retransmits_per_sec\":%.2f,\"backlog\":%i,\"avg_backlog\":%.2f,\"max_backlog\":%i,\"sent_by_type\":{",
+        m_stats.retransmits, m_stats.retransmitsPerSec, m_stats.reliableBacklog, m_stats.avgReliableBacklog, m_stats.maxReliableBacklog);
+
+    bool isFirst = true;
+    for (int i = 0; i < NUM_NET_MESSAGE_TYPES; i++) {
+        MessageTypeMetrics const& type = m_stats.messageTypes[i];
+        if (type.sentMessages == 0) {
+            continue;
+        }
+        json += Stringf("%s\"%s\":{\"messages\":%lld,\"bytes\":%lld}", isFirst ? "" : ",",
+            GetNameForMessageType((eNetMessageHeaderType)i), type.sentMessages, type.sentBytes);
+        isFirst = false;
+    }
+    json += "}}";
+    return json;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ConnectionMetrics::TakeWindowSnapshot(double now)
+{
+    m_windowStartTime = now;
+    m_windowSentPackets = m_stats.sentPackets;
+    m_windowSentBytes = m_stats.sentBytes;
+    m_windowReceivedPackets = m_stats.receivedPackets;
+    m_windowReceivedBytes = m_stats.receivedBytes;
+    m_windowRetransmits = m_stats.retransmits;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Game/NetworkMessage.hpp"
+#include <string>
+
+struct ConnectionStats;
+
+constexpr double NET_METRICS_WINDOW_SECONDS = 1.0;  //rates measured over windows this long
+constexpr float NET_METRICS_EWMA_ALPHA = .25f;      //weight of newest window or backlog sample
+
+//////////////////////////////////////////////////////////////////////////
+struct MessageTypeMetrics
+{
+    long long sentMessages = 0;
+    long long sentBytes = 0;    //before compression, includes every resend
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct ConnectionMetricsStats
+{
+    long long sentPackets = 0;
+    long long sentBytes = 0;
+    long long receivedPackets = 0;
+    long long receivedBytes = 0;
+    long long retransmits = 0;  //reliable messages sent again once a measured resend timeout passed without their ack
+
+    //moving averages of per window rates
+    float sentPacketsPerSec = 0.f;
+    float sentBytesPerSec = 0.f;
+    float receivedPacketsPerSec = 0.f;
+    float receivedBytesPerSec = 0.f;
+    float retransmitsPerSec = 0.f;
+
+    int reliableBacklog = 0;    //unacked reliable messages at last send
+    float avgReliableBacklog = 0.f;
+    int maxReliableBacklog = 0;
+
+    MessageTypeMetrics messageTypes[NUM_NET_MESSAGE_TYPES];
+};
+
+// per connection traffic counters and smoothed rates, rtt and loss stay in NetConnection
+class ConnectionMetrics
+{
+public:
+    void RecordSentPacket(int bytes);
+    void RecordReceivedPacket(int bytes);
+    void RecordSentMessage(eNetMessageHeaderType type, int bytes);
+    void RecordRetransmit() {m_stats.retransmits++;}
+    void SampleReliableBacklog(int count);
+    void Update(double now);
+
+    ConnectionMetricsStats const& GetStats() const {return m_stats;}
+    std::string MakeSummary(ConnectionStats const& connection) const;
+    std::string MakeJson(int identifier, ConnectionStats const& connection, double now) const;
+
+private:
+    void TakeWindowSnapshot(double now);
+
+private:
+    ConnectionMetricsStats m_stats;
+    double m_windowStartTime = 0.0;
+    bool m_hasRates = false;
+    long long m_windowSentPackets = 0;
+    long long m_windowSentBytes = 0;
+    long long m_windowReceivedPackets = 0;
+    long long m_windowReceivedBytes = 0;
+    long long m_windowRetransmits = 0;
+    bool m_hasBacklogSample = false;
+};
\ No newline at end of file
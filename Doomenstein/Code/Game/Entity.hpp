@@ -40,6 +40,7 @@ public:
     void RotateDeltaPitchYawRollDegrees(Vec3 const& deltaDegrees);
 
     void SetIsControlledByAI(bool isAIControlled);
+    void SetIsPlayerPawn(bool isPlayerPawn) {m_isPlayerPawn = isPlayerPawn;}
     bool SetAnimationName(char const* animName);
 
     EntityDef const*        GetEntityDefinition() const {return m_entityDef;}
@@ -51,6 +52,7 @@ public:
     bool        CanPushEntities() const;
     bool        CanPushedByWalls() const;
     bool        IsGarbage() const {return m_isGarbage;}
+    bool        IsPlayerPawn() const {return m_isPlayerPawn;}    //possessed by a client on this side
     float       GetWalkSpeed() const;
     float       GetEntityHeight() const;
     float       GetEntityRadius() const;
@@ -81,6 +83,7 @@ protected:
 
     bool m_isGarbage = false;
     bool m_isControlledByAI = true;
+    bool m_isPlayerPawn = false;
     float m_timerAI = 0.f;
     RaycastResult m_raycast;
 
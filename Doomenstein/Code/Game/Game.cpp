@@ -32,12 +32,13 @@
 #include "Engine/Core/AxisConvention.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
 
+static char const* TELEPORT_SOUND_PATH = "data/audio/Teleporter.wav";
+
 //////////////////////////////////////////////////////////////////////////
 void Game::StartUp()
 {
     g_theGame = this;
     m_gameClock = new Clock();
-    g_theObserver->UpdateSendTimer(m_gameClock);
     g_theRNG = new RandomNumberGenerator();
     g_theRenderer->SetupParentClock(m_gameClock);
     g_theFont = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/SquirrelFixedFont");
@@ -113,7 +114,7 @@ void Game::InitializeAssets(AudioSystem* audioSys, RenderContext* rtx)
     MapMaterialType::InitRenderAssets();
     m_world->InitForRenderAssets();
 
-    m_testSoundID = audioSys->CreateOrGetSound("data/audio/Teleporter.wav");
+    m_testSoundID = audioSys->CreateOrGetSound(TELEPORT_SOUND_PATH);
     Texture* hudTex = rtx->CreateOrGetTextureFromFile("data/images/hud_base.png");
     rtx->CreateOrGetTextureFromFile("data/images/terrain_8x8.png");
     Texture* viewTex = rtx->CreateOrGetTextureFromFile("data/images/viewModelsSpriteSheet_8x8.png");
@@ -199,15 +200,13 @@ void Game::UpdateCameraForPawn(Entity* playerPawn)
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Game::UpdatePlayerForInput(Entity* playerPawn, InputInfo const& info)
+void Game::UpdatePlayerForInput(Entity* playerPawn, InputInfo const& info, float deltaSeconds)
 {
     if (playerPawn == nullptr) {
         g_theConsole->PrintString(Rgba8::YELLOW, "update null pawn for input info");
         return;
     }
 
-    float deltaSeconds = (float)m_gameClock->GetLastDeltaSeconds();
-
     Vec2 actualMove = info.playerMove * playerPawn->GetWalkSpeed() * deltaSeconds;
     Vec3 pawnForward = playerPawn->GetEntityForward();
     Vec2 forward(pawnForward.x,pawnForward.y);
@@ -258,6 +257,19 @@ Entity* Game::GetEntityOfIndex(int idx) const
     return nullptr;
 }
 
+//////////////////////////////////////////////////////////////////////////
+std::vector<std::string> Game::GetMapNames() const
+{
+    return m_world->GetMapNames();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// sounds that may be played over the network
+std::vector<std::string> Game::GetSoundPaths() const
+{
+    return std::vector<std::string>{TELEPORT_SOUND_PATH};
+}
+
 //////////////////////////////////////////////////////////////////////////
 void Game::UpdateInputForMovement(InputInfo& info) const
 {
@@ -321,8 +333,15 @@ void Game::RenderForUI(Entity* playerPawn) const
     }
 
     //debug text
-    std::string printText = Stringf("[F1] Debug Mode\nFrametime: %.5f\nFPS: %.2f\n[-,+] Send: %.1f", m_gameClock->GetLastDeltaSeconds(), 
+    std::string printText = Stringf("[F1] Debug Mode\n[F2] Net Stats\nFrametime: %.5f\nFPS: %.2f\n[-,+] Send: %.1f", m_gameClock->GetLastDeltaSeconds(), 
         1.0 / m_gameClock->GetLastDeltaSeconds(), g_sendRatePerSec);
+    if (g_showNetStats) {
+        for (Client* c : g_theServer->m_clients) {
+            if (c->m_transport != nullptr) {
+                printText += Stringf("\nClient %i: %s", c->m_identifier, c->m_metrics.MakeSummary(c->m_connection.GetStats()).c_str());
+            }
+        }
+    }
     g_theFont->AddVertsForTextInBox2D(verts, bounds, 15.f, printText.c_str(),
         Rgba8::WHITE, 1.f, ALIGN_TOP_RIGHT);
     g_theRenderer->BindDiffuseTexture(g_theFont->GetTexture());
@@ -48,13 +48,16 @@ public:
 
     virtual void PlayTeleportSound() const;
     virtual void UpdateCameraForPawn(Entity* playerPawn);
-    virtual void UpdatePlayerForInput(Entity* playerPawn, InputInfo const& info);
+    virtual void UpdatePlayerForInput(Entity* playerPawn, InputInfo const& info, float deltaSeconds);
 
     virtual void RenderForRaycastDebug(Entity* pawn) const;
 
     virtual void UpdateKeyboardStates(InputInfo& input) const;
 
     Entity* GetEntityOfIndex(int idx) const;
+    std::vector<Entity*> const& GetEntities() const {return m_entities;}
+    std::vector<std::string> GetMapNames() const;
+    std::vector<std::string> GetSoundPaths() const;
     Clock* GetClock() const { return m_gameClock; }
 
 protected:
@@ -14,12 +14,15 @@ InputSystem* g_theInput = nullptr;
 AudioSystem* g_theAudio = nullptr;
 RenderContext* g_theRenderer = nullptr;
 NetworkObserver* g_theObserver = nullptr;
+NetIOThread* g_theNetIO = nullptr;
 RandomNumberGenerator* g_theRNG = nullptr;
 BitmapFont* g_theFont = nullptr;
 Game* g_theGame = nullptr;
 
 bool g_debugDrawing = false;
 float g_sendRatePerSec = 30.f;
+bool g_compressPackets = true;
+bool g_showNetStats = false;
 
 //////////////////////////////////////////////////////////////////////////
 void GetBillboardDirsFromCamAndMethod(Vec3 const& camPos, Vec3 const& camForward, Vec3 const& entityPos, eBillboardMode method, Vec3& up, Vec3& left)
@@ -8,6 +8,7 @@ class InputSystem;
 class AudioSystem;
 class RenderContext;
 class NetworkObserver;
+class NetIOThread;
 class BitmapFont;
 class RandomNumberGenerator;
 class Game;
@@ -17,6 +18,18 @@ constexpr float LINE_THICKNESS = .05f;
 constexpr float CAMERA_MOVE_SPEED = 2.f;
 constexpr float CAMERA_ROTATE_SPEED = 1000.f;
 constexpr float SEND_RATE_CHANGE_RATE = 5.f;
+constexpr float MIN_SEND_RATE_PER_SEC = 10.f;
+constexpr float MAX_SEND_RATE_PER_SEC = 30.f;
+constexpr int CLIENT_SEND_BUDGET_BYTES = 2048;
+constexpr float MAX_INPUT_DELTA_SECONDS = .1f;
+constexpr int REDUNDANT_INPUT_PACKETS = 4;      //unacked inputs ride on this many sends
+constexpr int MAX_REDUNDANT_INPUTS = 128;       //frames per send at min send rate times packets, ~300fps
+constexpr int MAX_INPUTS_PER_MESSAGE = 32;      //longer windows go out as several messages
+constexpr float MAX_PROJECTILE_CATCH_UP_SECONDS = .5f;
+constexpr float HANDSHAKE_RETRY_SECONDS = .25f;
+constexpr int HANDSHAKE_MAX_RETRIES = 20;
+constexpr float HANDSHAKE_TIMEOUT_SECONDS = 5.f;     //server forgets unanswered challenges
+constexpr int HANDSHAKE_MAX_PENDING = 64;           //full table evicts accepted, then oldest, also caps challenges per frame
 
 extern App* g_theApp;
 extern Server* g_theServer;
@@ -25,12 +38,15 @@ extern InputSystem* g_theInput;
 extern AudioSystem* g_theAudio;
 extern RenderContext* g_theRenderer;
 extern NetworkObserver* g_theObserver;
+extern NetIOThread* g_theNetIO;
 extern RandomNumberGenerator* g_theRNG;
 extern BitmapFont* g_theFont;
 extern Game* g_theGame;
 
 extern bool g_debugDrawing;
 extern float g_sendRatePerSec;
+extern bool g_compressPackets;
+extern bool g_showNetStats;
 
 //////////////////////////////////////////////////////////////////////////
 enum eBillboardMode
@@ -52,5 +68,8 @@ struct InputInfo
     bool isFiring = false;
     bool isClosing = false;
 
+    unsigned short seq = 0;         //for prediction and reconciliation
+    float deltaSeconds = 0.f;       //frame time the input was sampled over
+
     bool operator==(InputInfo const& other);
 };
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "Game/InputJitterBuffer.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+void InputJitterBuffer::Reset()
+{
+    m_inputs.Reset();
+    m_nextSeq = 0;
+    m_newestSeq = 0;
+    m_hasStarted = false;
+    m_isBuffering = true;
+    m_bufferedSeconds = 0.f;
+    m_timeBudget = 0.f;
+    m_targetSeconds = JITTER_START_SECONDS;
+    m_catchUpSeconds = 0.f;
+    m_windowTicks = 0;
+    m_windowMinSeconds = INPUT_BUFFER_SIZE * MAX_INPUT_DELTA_SECONDS;
+    m_starvedInWindow = false;
+    m_stats = InputBufferStats();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void InputJitterBuffer::Insert(InputInfo const& input)
+{
+    unsigned short seq = input.seq;
+    if (!m_hasStarted) {
+        m_hasStarted = true;
+        m_nextSeq = seq;
+        m_newestSeq = seq;
+    }
+    else if (IsSequenceGreaterThan(m_nextSeq, seq)) {
+        return;     //already consumed or skipped
+    }
+    else if (m_inputs.Find(seq) != nullptr) {
+        return;     //redundant copy
+    }
+
+    if (IsSequenceGreaterThan(seq, m_newestSeq)) {
+        m_newestSeq = seq;
+    }
+
+    //too far behind, drop oldest to make room
+    while (GetDepth() > INPUT_BUFFER_SIZE) {
+        InputInfo* dropped = m_inputs.Find(m_nextSeq);
+        if (dropped) {
+            m_bufferedSeconds -= dropped->deltaSeconds;
+            m_inputs.Remove(m_nextSeq);
+            m_stats.overflowInputs++;
+        }
+        m_nextSeq++;
+    }
+
+    *m_inputs.Insert(seq) = input;
+    m_bufferedSeconds += input.deltaSeconds;
+    m_stats.receivedInputs++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// inputs until their time covers the tick, none while filling, up to double while catching up
+void InputJitterBuffer::PopTickInputs(std::vector<InputInfo>& inputs, float tickSeconds)
+{
+    inputs.clear();
+    if (!m_hasStarted) {
+        return;
+    }
+
+    if (m_isBuffering) {
+        if (m_bufferedSeconds < m_targetSeconds) {
+            UpdateWindow();
+            return;
+        }
+        m_isBuffering = false;
+        m_timeBudget = 0.f;
+    }
+
+    float catchUp = m_catchUpSeconds < tickSeconds ? m_catchUpSeconds : tickSeconds;
+    m_catchUpSeconds -= catchUp;
+    m_stats.catchUpSeconds += catchUp;
+    m_timeBudget += tickSeconds + catchUp;
+
+    InputInfo input;
+    while (m_timeBudget > 0.f) {
+        if (!PopNext(input)) {
+            m_stats.starvedTicks++;
+            m_starvedInWindow = true;
+            m_targetSeconds = m_targetSeconds + JITTER_STEP_SECONDS < JITTER_MAX_SECONDS ? m_targetSeconds + JITTER_STEP_SECONDS : JITTER_MAX_SECONDS;
+            m_isBuffering = true;
+            m_timeBudget = 0.f;
+            break;
+        }
+        inputs.push_back(input);
+        m_timeBudget -= input.deltaSeconds > MIN_PLAYBACK_INPUT_SECONDS ? input.deltaSeconds : MIN_PLAYBACK_INPUT_SECONDS;
+    }
+    m_stats.consumedInputs += (int)inputs.size();
+    UpdateWindow();
+}
+
+//////////////////////////////////////////////////////////////////////////
+int InputJitterBuffer::GetDepth() const
+{
+    if (!m_hasStarted) {
+        return 0;
+    }
+    return (int)(unsigned short)(m_newestSeq - m_nextSeq + 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool InputJitterBuffer::PopNext(InputInfo& input)
+{
+    while (GetDepth() > 0) {
+        unsigned short seq = m_nextSeq++;
+        InputInfo* found = m_inputs.Find(seq);
+        if (found) {
+            input = *found;
+            m_inputs.Remove(seq);
+            m_bufferedSeconds = GetDepth() > 0 ? m_bufferedSeconds - input.deltaSeconds : 0.f;
+            return true;
+        }
+        m_stats.lostInputs++;
+    }
+    m_bufferedSeconds = 0.f;
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// sampled after consuming, what is left is the cushion for the next tick;
+// shrink target and drain excess after a window without starvation
+void InputJitterBuffer::UpdateWindow()
+{
+    m_stats.depthSecondsSum += m_bufferedSeconds;
+    m_stats.depthSamples++;
+    m_stats.maxDepthSeconds = m_bufferedSeconds > m_stats.maxDepthSeconds ? m_bufferedSeconds : m_stats.maxDepthSeconds;
+    m_windowMinSeconds = m_bufferedSeconds < m_windowMinSeconds ? m_bufferedSeconds : m_windowMinSeconds;
+
+    m_windowTicks++;
+    if (m_windowTicks < JITTER_WINDOW_TICKS) {
+        return;
+    }
+
+    if (!m_starvedInWindow && m_targetSeconds > JITTER_MIN_SECONDS) {
+        m_targetSeconds = m_targetSeconds - JITTER_STEP_SECONDS > JITTER_MIN_SECONDS ? m_targetSeconds - JITTER_STEP_SECONDS : JITTER_MIN_SECONDS;
+    }
+    m_catchUpSeconds = m_windowMinSeconds > m_targetSeconds ? m_windowMinSeconds - m_targetSeconds : 0.f;
+
+    m_windowTicks = 0;
+    m_windowMinSeconds = INPUT_BUFFER_SIZE * MAX_INPUT_DELTA_SECONDS;
+    m_starvedInWindow = false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+#include "Game/SequenceBuffer.hpp"
+#include <vector>
+
+constexpr int INPUT_BUFFER_SIZE = 256;
+constexpr float JITTER_MIN_SECONDS = .016f;
+constexpr float JITTER_MAX_SECONDS = .133f;
+constexpr float JITTER_START_SECONDS = .033f;
+constexpr float JITTER_STEP_SECONDS = .016f;    //target change on starvation or a calm window
+constexpr float MIN_PLAYBACK_INPUT_SECONDS = .001f;     //zero length inputs still use up tick time
+constexpr int JITTER_WINDOW_TICKS = 120;
+
+//////////////////////////////////////////////////////////////////////////
+struct InputBufferStats
+{
+    int receivedInputs = 0;
+    int consumedInputs = 0;
+    int starvedTicks = 0;
+    int lostInputs = 0;         //never arrived, skipped
+    int overflowInputs = 0;     //dropped when buffer full
+    float catchUpSeconds = 0.f; //extra input time played to shrink latency
+    float maxDepthSeconds = 0.f;
+    double depthSecondsSum = 0.0;
+    int depthSamples = 0;
+};
+
+// server side per client queue indexed by input seq, played back by input time:
+// each tick consumes inputs covering the tick's duration whatever the client's frame rate
+class InputJitterBuffer
+{
+public:
+    void Reset();
+
+    void Insert(InputInfo const& input);
+    void PopTickInputs(std::vector<InputInfo>& inputs, float tickSeconds);
+
+    int GetDepth() const;
+    float GetBufferedSeconds() const {return m_bufferedSeconds;}
+    float GetTargetSeconds() const {return m_targetSeconds;}
+    InputBufferStats const& GetStats() const {return m_stats;}
+
+private:
+    bool PopNext(InputInfo& input);
+    void UpdateWindow();
+
+private:
+    SequenceBuffer<InputInfo, INPUT_BUFFER_SIZE> m_inputs;
+    unsigned short m_nextSeq = 0;
+    unsigned short m_newestSeq = 0;
+    bool m_hasStarted = false;
+    bool m_isBuffering = true;
+    float m_bufferedSeconds = 0.f;  //input time of buffered inputs
+    float m_timeBudget = 0.f;       //tick time not yet covered by inputs, negative if an input overran
+
+    float m_targetSeconds = JITTER_START_SECONDS;
+    float m_catchUpSeconds = 0.f;
+    int m_windowTicks = 0;
+    float m_windowMinSeconds = INPUT_BUFFER_SIZE * MAX_INPUT_DELTA_SECONDS;
+    bool m_starvedInWindow = false;
+
+    InputBufferStats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Game/InputPredictor.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/SequenceBuffer.hpp"
+#include "Game/Entity.hpp"
+#include "Game/Game.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+void InputPredictor::Reset()
+{
+    m_history.clear();
+    m_nextSeq = 0;
+    m_lastAckedSeq = 0;
+    m_hasAcked = false;
+    m_sendEndSeqs.clear();
+    m_stats = PredictionStats();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void InputPredictor::RecordInput(InputInfo const& input, Entity const* pawn)
+{
+    if ((int)m_history.size() >= MAX_PREDICTED_INPUTS) {
+        m_history.pop_front();
+    }
+
+    PredictedInput predicted;
+    predicted.input = input;
+    predicted.position = pawn->GetEntityPosition2D();
+    predicted.pitchYawRoll = pawn->GetEntityPitchYawRollDegrees();
+    m_history.push_back(predicted);
+    m_stats.predictedInputs++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void InputPredictor::Reconcile(PlayerStateInfo const& state, Entity* pawn, Game* game)
+{
+    //out of order or duplicate state
+    if (m_hasAcked && !IsSequenceGreaterThan(state.lastInputSeq, m_lastAckedSeq)) {
+        return;
+    }
+    m_hasAcked = true;
+    m_lastAckedSeq = state.lastInputSeq;
+
+    Vec2 serverPos(state.x, state.y);
+    bool isFound = false;
+    Vec2 predictedPos;
+    while (!m_history.empty() && !IsSequenceGreaterThan(m_history.front().input.seq, state.lastInputSeq)) {
+        if (m_history.front().input.seq == state.lastInputSeq) {
+            isFound = true;
+            predictedPos = m_history.front().position;
+        }
+        m_history.pop_front();
+    }
+
+    float errorDist = (predictedPos - serverPos).GetLength();
+    if (isFound && errorDist <= PREDICTION_ERROR_TOLERANCE) {
+        return;
+    }
+
+    //rewind to server state and replay what server has not processed yet
+    m_stats.corrections++;
+    m_stats.lastCorrectionDist = isFound ? errorDist : 0.f;
+    m_stats.maxCorrectionDist = m_stats.lastCorrectionDist > m_stats.maxCorrectionDist ? m_stats.lastCorrectionDist : m_stats.maxCorrectionDist;
+
+    Vec3 pitchYawRoll = pawn->GetEntityPitchYawRollDegrees();
+    pitchYawRoll.x = state.pitch;
+    pitchYawRoll.y = state.yaw;
+    pawn->SetPosition(serverPos);
+    pawn->SetPitchYawRollDegrees(pitchYawRoll);
+    for (PredictedInput& predicted : m_history) {
+        game->UpdatePlayerForInput(pawn, predicted.input, predicted.input.deltaSeconds);
+        predicted.position = pawn->GetEntityPosition2D();
+        predicted.pitchYawRoll = pawn->GetEntityPitchYawRollDegrees();
+        m_stats.replayedInputs++;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// unacked inputs first sent in the last REDUNDANT_INPUT_PACKETS sends or not sent yet,
+// oldest first, so the window covers packets however many frames each send spans
+void InputPredictor::GetRedundantInputs(std::vector<InputInfo>& inputs, int maxCount) const
+{
+    inputs.clear();
+    size_t first = 0;
+    if ((int)m_sendEndSeqs.size() >= REDUNDANT_INPUT_PACKETS) {
+        unsigned short windowStartSeq = m_sendEndSeqs.front();
+        while (first < m_history.size() && IsSequenceGreaterThan(windowStartSeq, m_history[first].input.seq)) {
+            first++;
+        }
+    }
+    if (m_history.size() - first > (size_t)maxCount) {
+        first = m_history.size() - (size_t)maxCount;
+    }
+    for (size_t i = first; i < m_history.size(); i++) {
+        inputs.push_back(m_history[i].input);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// oldest kept end is where the next send's window starts
+void InputPredictor::RecordSend()
+{
+    m_sendEndSeqs.push_back(m_nextSeq);
+    while ((int)m_sendEndSeqs.size() > REDUNDANT_INPUT_PACKETS) {
+        m_sendEndSeqs.pop_front();
+    }
+}
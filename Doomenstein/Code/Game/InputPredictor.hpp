@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <deque>
+#include <vector>
+
+class Entity;
+class Game;
+struct PlayerStateInfo;
+
+constexpr int MAX_PREDICTED_INPUTS = 256;
+constexpr float PREDICTION_ERROR_TOLERANCE = .01f;
+
+//////////////////////////////////////////////////////////////////////////
+struct PredictedInput
+{
+    InputInfo input;
+    Vec2 position;          //pawn state after input applied
+    Vec3 pitchYawRoll;
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct PredictionStats
+{
+    int predictedInputs = 0;
+    int corrections = 0;
+    int replayedInputs = 0;
+    float lastCorrectionDist = 0.f;
+    float maxCorrectionDist = 0.f;
+};
+
+// client side prediction of own pawn, replays unacked inputs on server correction
+class InputPredictor
+{
+public:
+    void Reset();
+
+    unsigned short GetNextSeq() {return m_nextSeq++;}
+    void RecordInput(InputInfo const& input, Entity const* pawn);
+    void Reconcile(PlayerStateInfo const& state, Entity* pawn, Game* game);
+    void GetRedundantInputs(std::vector<InputInfo>& inputs, int maxCount) const;
+    void RecordSend();
+
+    size_t GetPendingCount() const {return m_history.size();}
+    PredictionStats const& GetStats() const {return m_stats;}
+
+private:
+    std::deque<PredictedInput> m_history;
+    unsigned short m_nextSeq = 0;
+    unsigned short m_lastAckedSeq = 0;
+    bool m_hasAcked = false;
+    std::deque<unsigned short> m_sendEndSeqs;   //next seq at each of the last sends
+
+    PredictionStats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,450 @@
+#include "Game/LoopbackPeer.hpp"
+#include "Game/NetTransport.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/NetBufferReader.hpp"
+#include "Game/NetCompression.hpp"
+#include "Game/Server.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/SequenceBuffer.hpp"
+#include "Engine/Network/NetworkCommon.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+static char const* sBotInputPatternNames[NUM_BOT_INPUT_PATTERNS] = {"none", "random", "circle", "strafe", "firefight"};
+
+//////////////////////////////////////////////////////////////////////////
+// unknown names fall back to none
+eBotInputPattern GetBotInputPatternForName(std::string const& name)
+{
+    for (int i = 0; i < NUM_BOT_INPUT_PATTERNS; i++) {
+        if (name == sBotInputPatternNames[i]) {
+            return (eBotInputPattern)i;
+        }
+    }
+    return BOT_INPUT_NONE;
+}
+
+//////////////////////////////////////////////////////////////////////////
+char const* GetNameForBotInputPattern(eBotInputPattern pattern)
+{
+    return sBotInputPatternNames[pattern];
+}
+
+//////////////////////////////////////////////////////////////////////////
+LoopbackPeer::LoopbackPeer(NetTransport* transport, int identifier)
+    : m_transport(transport)
+    , m_identifier(identifier)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+LoopbackPeer::~LoopbackPeer()
+{
+    delete m_transport;
+    m_transport = nullptr;
+    if (m_replyPort != 0) {
+        ReleaseUsedPort(m_replyPort);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// same request a remote server makes once its udp socket is up
+void LoopbackPeer::Join(double now)
+{
+    m_stats.joinTime = now;
+    QueueMessage(MakeAddPlayerMessage(g_theServer->m_stringTables));
+    SendPacket();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// add player rides on the response like a remote server's, key comes with the accept
+void LoopbackPeer::Connect(std::string const& replyIP, int replyPort, double now)
+{
+    m_stats.joinTime = now;
+    m_replyIP = replyIP;
+    m_replyPort = replyPort;
+    m_isHandshaking = true;
+    m_handshakeStep = HANDSHAKE_REQUEST;
+    m_handshakeNonce = RollSecretNumber();
+    m_handshakeRetries = 0;
+    m_addPlayerContent = MakeAddPlayerMessage(g_theServer->m_stringTables).substr(MESSAGE_HEADER_LEN);
+    SendHandshakeStep(now);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::Update(double now)
+{
+    if (!IsConnected()) {
+        return;
+    }
+
+    while (m_transport->Receive(m_receiveBuffer)) {
+        ReceivePacket(m_receiveBuffer, now);
+    }
+    if (m_isHandshaking) {
+        UpdateHandshake(now);
+        return;
+    }
+    m_fragments.RemoveExpired(now);
+    UpdateInput(now);
+
+    //answer every batch so server gets acks for its reliables
+    if (m_unansweredPackets > 0 || !m_pendingMsgs.empty()) {
+        SendPacket();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::Disconnect()
+{
+    if (!IsConnected()) {
+        return;
+    }
+    if (m_isHandshaking) {
+        m_transport->Close();   //server has no key to drop yet
+        return;
+    }
+
+    std::string quit = MakeClientQuitPackage();
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&quit[0]);
+    headerPtr->m_key = m_identifier;
+    m_transport->Send(quit);
+    m_transport->Close();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::QueueMessage(std::string const& msg)
+{
+    m_pendingMsgs.push_back(msg);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::SetInputPattern(eBotInputPattern pattern, unsigned int seed)
+{
+    m_inputPattern = pattern;
+    m_rng.seed(seed);
+    m_input = InputInfo();
+    m_nextInputChangeTime = 0.0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool LoopbackPeer::IsConnected() const
+{
+    return m_transport && m_transport->IsValid();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::ReceivePacket(std::string const& packet, double now)
+{
+    if (packet.size() < NET_HEADER_LEN) {
+        m_stats.corruptPackets++;
+        return;
+    }
+
+    NetworkPackageHeader const* headerPtr = reinterpret_cast<NetworkPackageHeader const*>(&packet[0]);
+    if (packet.size() - NET_HEADER_LEN < headerPtr->m_size) {
+        m_stats.corruptPackets++;
+        return;
+    }
+    if (headerPtr->m_type == eNetworkPackageHeaderType::HEAD_SERVER_LISTEN) {
+        HandleHandshake(std::string_view(&packet[NET_HEADER_LEN], headerPtr->m_size), now);
+        return;
+    }
+    if (headerPtr->m_type != eNetworkPackageHeaderType::HEAD_TEXT || m_isHandshaking) {
+        return;
+    }
+
+    m_stats.receivedPackets++;
+    m_stats.receivedBytes += (long long)packet.size();
+    m_unansweredPackets++;
+
+    NetPacketReader reader(&packet[NET_HEADER_LEN], headerPtr->m_size);
+    NetPacketHeader packetHeader;
+    std::vector<unsigned short> ackedIds;
+    if (!reader.ReadPacketHeader(packetHeader)) {
+        m_stats.corruptPackets++;
+        return;
+    }
+    if (!m_connection.ReceivePacketHeader(packetHeader, now, ackedIds)) {
+        return;     //duplicate
+    }
+
+    if (packetHeader.m_flags & PACKET_FLAG_COMPRESSED) {
+        if (!DecompressPacketContent(&packet[PACKET_PREFIX_LEN], headerPtr->m_size - PACKET_HEADER_LEN, m_decompressed, PACKET_MAX_CONTENT_LEN)) {
+            m_stats.corruptPackets++;
+            return;
+        }
+        reader = NetPacketReader(m_decompressed.data(), m_decompressed.size());
+    }
+
+    NetMessageHeader header;
+    std::string_view content;
+    while (reader.ReadMessage(header, content)) {
+        if (header.m_type != eNetMessageHeaderType::MESSAGE_FRAGMENT) {
+            HandleMessage(header, content, now);
+            continue;
+        }
+        if (!m_fragments.ReceiveFragment(content, now, m_reassembled)) {
+            continue;
+        }
+
+        NetPacketReader messageReader(m_reassembled.data(), m_reassembled.size());
+        NetMessageHeader wholeHeader;
+        std::string_view wholeContent;
+        if (messageReader.ReadMessage(wholeHeader, wholeContent)) {
+            HandleMessage(wholeHeader, wholeContent, now);
+        }
+    }
+    if (reader.HasError()) {
+        m_stats.corruptPackets++;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// repeats of a step already answered are ignored, retries come from UpdateHandshake
+void LoopbackPeer::HandleHandshake(std::string_view content, double now)
+{
+    HandshakeInfo info;
+    if (!m_isHandshaking || !ParseHandshakePackage(content, info) || info.nonce != m_handshakeNonce) {
+        return;
+    }
+
+    switch (info.step) {
+    case HANDSHAKE_CHALLENGE:    {
+        if (m_handshakeStep != HANDSHAKE_REQUEST) {
+            break;
+        }
+        m_handshakeStep = HANDSHAKE_RESPONSE;
+        m_handshakeToken = info.token;
+        m_handshakeRetries = 0;
+        SendHandshakeStep(now);
+        break;
+    }
+    case HANDSHAKE_ACCEPT:    {
+        m_identifier = info.identifier;
+        m_isHandshaking = false;
+        break;
+    }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::UpdateHandshake(double now)
+{
+    if (now - m_lastHandshakeSendTime < HANDSHAKE_RETRY_SECONDS) {
+        return;
+    }
+
+    if (m_handshakeRetries >= HANDSHAKE_MAX_RETRIES) {
+        g_theConsole->PrintError(Stringf("Bot got no answer from server after %i retries", m_handshakeRetries));
+        m_isHandshaking = false;
+        m_transport->Close();
+        return;
+    }
+    m_handshakeRetries++;
+    SendHandshakeStep(now);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::SendHandshakeStep(double now)
+{
+    HandshakeInfo info;
+    info.step = m_handshakeStep;
+    info.nonce = m_handshakeNonce;
+    info.token = m_handshakeToken;
+    info.replyIP = m_replyIP;
+    info.replyPort = m_replyPort;
+    info.addPlayer = m_addPlayerContent;
+    std::string packet = MakeHandshakePackage(info);
+    if (m_transport->Send(packet)) {
+        m_stats.sentPackets++;
+        m_stats.sentBytes += (long long)packet.size();
+    }
+    m_lastHandshakeSendTime = now;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// tracks which entities this peer knows of, without a world of its own
+void LoopbackPeer::HandleMessage(NetMessageHeader const& header, std::string_view content, double now)
+{
+    m_stats.receivedMessages++;
+    switch (header.m_type) {
+    case MESSAGE_ENTITY_BASELINE:    {
+        if (m_stats.readyTime <= 0.0) {
+            m_stats.readyTime = now;
+        }
+        NetMessageReader records(content);
+        std::string_view record;
+        while (records.ReadToken(record, '|')) {
+            NetMessageReader reader(record);
+            int idx = -1;
+            if (reader.ReadInt(idx)) {
+                m_knownEntities.insert(idx);
+            }
+        }
+        break;
+    }
+    case MESSAGE_ENTITY_CREATE:    {
+        NetMessageReader reader(content);
+        int idx = -1;
+        if (reader.ReadInt(idx)) {
+            m_knownEntities.insert(idx);
+        }
+        break;
+    }
+    case MESSAGE_ENTITY_DELETE:    {
+        NoteEntityUpdate(content, now);
+        NetMessageReader reader(content);
+        int idx = -1;
+        if (reader.ReadInt(idx)) {
+            m_knownEntities.erase(idx);
+        }
+        break;
+    }
+    case MESSAGE_ENTITY_TRANSFORM:
+    case MESSAGE_ENTITY_TELEPORT:
+    case MESSAGE_ACTOR_HEALTH:    {
+        NoteEntityUpdate(content, now);
+        break;
+    }
+    case MESSAGE_PLAYER_STATE:    {
+        NetMessageReader reader(content);
+        int seq = 0;
+        if (!reader.ReadInt(seq)) {
+            break;
+        }
+        unsigned short ackedSeq = (unsigned short)seq;
+        if (m_stats.sentInputs == 0 || IsSequenceGreaterThan(ackedSeq, (unsigned short)(m_nextInputSeq - 1))) {
+            m_stats.inputEchoesAhead++;
+            break;
+        }
+        if (m_hasAckedInput && IsSequenceGreaterThan(m_lastAckedInputSeq, ackedSeq)) {
+            m_stats.staleStates++;
+            break;
+        }
+
+        m_hasAckedInput = true;
+        m_lastAckedInputSeq = ackedSeq;
+        size_t ackedCount = 0;
+        while (ackedCount < m_pendingInputs.size() && !IsSequenceGreaterThan(m_pendingInputs[ackedCount].seq, ackedSeq)) {
+            ackedCount++;
+        }
+        m_pendingInputs.erase(m_pendingInputs.begin(), m_pendingInputs.begin() + ackedCount);
+        break;
+    }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackPeer::NoteEntityUpdate(std::string_view content, double now)
+{
+    NetMessageReader reader(content);
+    int idx = -1;
+    if (!reader.ReadInt(idx) || m_knownEntities.find(idx) != m_knownEntities.end()) {
+        return;
+    }
+
+    if (IsReady() && now - m_stats.readyTime > BOT_JOIN_GRACE_SECONDS) {
+        m_stats.unknownEntityUpdates++;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one input per update once joined, unacked ones repeat like a real client's
+void LoopbackPeer::UpdateInput(double now)
+{
+    if (m_inputPattern == BOT_INPUT_NONE || !IsReady()) {
+        return;
+    }
+
+    switch (m_inputPattern) {
+    case BOT_INPUT_RANDOM:    {
+        if (now >= m_nextInputChangeTime) {
+            m_input.playerMove = Vec2(RollFloatInRange(-1.f, 1.f), RollFloatInRange(-1.f, 1.f));
+            m_input.mouseMove = Vec2(RollFloatInRange(-.2f, .2f), 0.f);
+            m_nextInputChangeTime = now + (double)RollFloatInRange(.5f, 2.f);
+        }
+        m_input.isFiring = RollFloatInRange(0.f, 1.f) < .02f;
+        break;
+    }
+    case BOT_INPUT_CIRCLE:    {
+        m_input.playerMove = Vec2(1.f, 0.f);
+        m_input.mouseMove = Vec2(.05f, 0.f);
+        break;
+    }
+    case BOT_INPUT_STRAFE:    {
+        if (now >= m_nextInputChangeTime) {
+            m_input.playerMove = Vec2(0.f, m_input.playerMove.y > 0.f ? -1.f : 1.f);
+            m_nextInputChangeTime = now + 1.0;
+        }
+        break;
+    }
+    case BOT_INPUT_FIREFIGHT:    {
+        if (now >= m_nextInputChangeTime) {
+            m_input.playerMove = Vec2(0.f, m_input.playerMove.y > 0.f ? -1.f : 1.f);
+            m_input.mouseMove = Vec2(RollFloatInRange(-.1f, .1f), 0.f);
+            m_nextInputChangeTime = now + (double)RollFloatInRange(.5f, 1.5f);
+        }
+        m_input.isFiring = true;
+        break;
+    }
+    }
+
+    InputInfo input = m_input;
+    input.seq = m_nextInputSeq++;
+    input.deltaSeconds = m_lastInputTime > 0.0 ? Clamp((float)(now - m_lastInputTime), 0.f, MAX_INPUT_DELTA_SECONDS) : 0.f;
+    m_lastInputTime = now;
+
+    m_pendingInputs.push_back(input);
+    if ((int)m_pendingInputs.size() > BOT_MAX_PENDING_INPUTS) {
+        m_pendingInputs.erase(m_pendingInputs.begin());
+    }
+    //one input per packet here, so the packet window is that many inputs
+    size_t count = m_pendingInputs.size() < (size_t)REDUNDANT_INPUT_PACKETS ? m_pendingInputs.size() : (size_t)REDUNDANT_INPUT_PACKETS;
+    m_redundantInputs.assign(m_pendingInputs.end() - count, m_pendingInputs.end());
+    QueueMessage(MakePlayerInputMessage(m_redundantInputs));
+    m_stats.sentInputs++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// own scaling so a seed gives the same inputs everywhere
+float LoopbackPeer::RollFloatInRange(float minValue, float maxValue)
+{
+    float zeroToOne = (float)(m_rng() >> 8) / 16777216.f;
+    return minValue + (maxValue - minValue) * zeroToOne;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one packet per call, queued messages that do not fit wait for the next
+void LoopbackPeer::SendPacket()
+{
+    m_sendBuffer.assign(MakeTextPackage(std::string(), false));
+    m_sendBuffer.resize(PACKET_PREFIX_LEN);
+
+    size_t sentMsgs = 0;
+    for (std::string const& msg : m_pendingMsgs) {
+        if (m_sendBuffer.size() + msg.size() > NET_HEADER_LEN + NET_MAX_DATA_LEN) {
+            break;
+        }
+        m_sendBuffer += msg;
+        sentMsgs++;
+    }
+    m_pendingMsgs.erase(m_pendingMsgs.begin(), m_pendingMsgs.begin() + sentMsgs);
+
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&m_sendBuffer[0]);
+    headerPtr->m_key = m_identifier;
+    headerPtr->m_size = (uint16_t)(m_sendBuffer.size() - NET_HEADER_LEN);
+    NetPacketHeader* packetHeader = reinterpret_cast<NetPacketHeader*>(&m_sendBuffer[NET_HEADER_LEN]);
+    m_connection.WritePacketHeader(m_noReliableIds, GetCurrentTimeSeconds(), *packetHeader);
+    packetHeader->m_serverTick = 0;
+    packetHeader->m_flags = 0;
+
+    m_unansweredPackets = 0;
+    if (m_transport->Send(m_sendBuffer)) {
+        m_stats.sentPackets++;
+        m_stats.sentBytes += (long long)m_sendBuffer.size();
+    }
+}
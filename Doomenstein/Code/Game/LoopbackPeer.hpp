@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+#include "Game/NetConnection.hpp"
+#include "Game/MessageFragmenter.hpp"
+#include "Game/NetworkMessage.hpp"
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+class NetTransport;
+struct NetMessageHeader;
+
+constexpr double BOT_JOIN_GRACE_SECONDS = 2.0;     //updates for unknown entities expected while baseline streams
+constexpr int BOT_MAX_PENDING_INPUTS = 128;
+
+//////////////////////////////////////////////////////////////////////////
+enum eBotInputPattern : int
+{
+    BOT_INPUT_NONE = 0,     //joins and acks only
+    BOT_INPUT_RANDOM,       //seeded random moves, turns and shots held for a while
+    BOT_INPUT_CIRCLE,       //walk forward while turning
+    BOT_INPUT_STRAFE,       //strafe left and right every second
+    BOT_INPUT_FIREFIGHT,    //strafe and turn with the trigger held
+
+    NUM_BOT_INPUT_PATTERNS
+};
+
+eBotInputPattern GetBotInputPatternForName(std::string const& name);
+char const* GetNameForBotInputPattern(eBotInputPattern pattern);
+
+//////////////////////////////////////////////////////////////////////////
+struct LoopbackPeerStats
+{
+    long long sentPackets = 0;
+    long long sentBytes = 0;
+    long long receivedPackets = 0;
+    long long receivedBytes = 0;
+    long long receivedMessages = 0;
+    long long corruptPackets = 0;
+    double joinTime = 0.0;
+    double readyTime = 0.0;     //first baseline chunk arrived
+
+    long long sentInputs = 0;
+    long long unknownEntityUpdates = 0; //after join grace, entity never seen in baseline or create
+    long long inputEchoesAhead = 0;     //server acked an input this peer never sent
+    long long staleStates = 0;          //out of order player state, dropped like a real client does
+    long long GetDesyncCount() const {return unknownEntityUpdates + inputEchoesAhead;}
+};
+
+// stand in for a remote player without a world, speaks the full packet protocol
+// either over a loopback link to a server side RemoteClient in the same process,
+// or over its own udp socket from another process, joining by the udp handshake
+// with an input pattern it is a load bot sending inputs every frame once joined
+class LoopbackPeer
+{
+public:
+    LoopbackPeer(NetTransport* transport, int identifier);
+    ~LoopbackPeer();
+
+    void Join(double now);      //loopback, server already made the client
+    void Connect(std::string const& replyIP, int replyPort, double now);   //udp, transport sends to the listen port
+    void Update(double now);    //drain polled packets, reply with acks and queued messages
+    void ReceivePacket(std::string const& packet, double now);  //udp packets are handed in by event
+    void Disconnect();
+
+    void QueueMessage(std::string const& msg);
+    void SetInputPattern(eBotInputPattern pattern, unsigned int seed);
+
+    bool IsConnected() const;
+    bool IsReady() const {return m_stats.readyTime > 0.0;}
+    eBotInputPattern GetInputPattern() const {return m_inputPattern;}
+    int GetIdentifier() const {return m_identifier;}
+    NetTransport* GetTransport() const {return m_transport;}
+    ConnectionStats const& GetConnectionStats() const {return m_connection.GetStats();}
+    LoopbackPeerStats const& GetStats() const {return m_stats;}
+
+private:
+    void HandleHandshake(std::string_view content, double now);
+    void UpdateHandshake(double now);
+    void SendHandshakeStep(double now);
+    void HandleMessage(NetMessageHeader const& header, std::string_view content, double now);
+    void SendPacket();
+    void UpdateInput(double now);
+    void NoteEntityUpdate(std::string_view content, double now);
+    float RollFloatInRange(float minValue, float maxValue);
+
+private:
+    NetTransport* m_transport = nullptr;  //owned
+    int m_identifier = -1;
+    int m_unansweredPackets = 0;    //received since the last send, each batch gets acked
+
+    //udp only, same steps a remote server takes
+    bool m_isHandshaking = false;
+    eHandshakeStep m_handshakeStep = HANDSHAKE_REQUEST;
+    unsigned int m_handshakeNonce = 0;
+    unsigned int m_handshakeToken = 0;
+    int m_handshakeRetries = 0;
+    double m_lastHandshakeSendTime = 0.0;
+    std::string m_replyIP;
+    int m_replyPort = 0;            //rolled for this peer, released with it
+    std::string m_addPlayerContent;
+
+    NetConnection m_connection;
+    FragmentReassembler m_fragments;
+    std::vector<std::string> m_pendingMsgs;
+    std::vector<unsigned short> m_noReliableIds;    //peer messages are unreliable
+
+    std::string m_receiveBuffer;
+    std::string m_sendBuffer;
+    std::string m_decompressed;
+    std::string m_reassembled;
+
+    LoopbackPeerStats m_stats;
+
+    eBotInputPattern m_inputPattern = BOT_INPUT_NONE;
+    std::mt19937 m_rng;
+    InputInfo m_input;              //held until pattern changes it
+    double m_nextInputChangeTime = 0.0;
+    double m_lastInputTime = 0.0;
+    unsigned short m_nextInputSeq = 0;
+    bool m_hasAckedInput = false;
+    unsigned short m_lastAckedInputSeq = 0;
+    std::vector<InputInfo> m_pendingInputs;     //unacked, newest at back
+    std::vector<InputInfo> m_redundantInputs;
+    std::unordered_set<int> m_knownEntities;
+};
\ No newline at end of file
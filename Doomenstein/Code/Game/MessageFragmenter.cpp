@@ -0,0 +1,207 @@
+#include "Game/MessageFragmenter.hpp"
+#include "Game/GameCommon.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////
+bool IsMessageOversized(std::string const& msg)
+{
+    return (int)msg.size() > PACKET_MAX_CONTENT_LEN;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// whole message including its header is split, receiver dispatches it as if unsplit
+bool MakeFragmentMessages(std::string const& msg, unsigned short group, std::vector<std::string>& fragments)
+{
+    fragments.clear();
+    int count = ((int)msg.size() + FRAGMENT_DATA_LEN - 1) / FRAGMENT_DATA_LEN;
+    if (count > MAX_FRAGMENT_COUNT) {
+        g_theConsole->PrintError(Stringf("Message of %i bytes too large to fragment", (int)msg.size()));
+        return false;
+    }
+
+    fragments.reserve(count);
+    for (int i = 0; i < count; i++) {
+        size_t offset = (size_t)i * FRAGMENT_DATA_LEN;
+        size_t dataLen = msg.size() - offset < (size_t)FRAGMENT_DATA_LEN ? msg.size() - offset : (size_t)FRAGMENT_DATA_LEN;
+
+        std::string fragment(MESSAGE_HEADER_LEN + FRAGMENT_HEADER_LEN + dataLen, '\0');
+        NetMessageHeader* msgHeader = reinterpret_cast<NetMessageHeader*>(&fragment[0]);
+        msgHeader->m_type = eNetMessageHeaderType::MESSAGE_FRAGMENT;
+        msgHeader->m_size = (unsigned short)(FRAGMENT_HEADER_LEN + dataLen);
+        msgHeader->m_seqNo = 0;
+
+        NetFragmentHeader fragHeader;
+        fragHeader.m_group = group;
+        fragHeader.m_index = (unsigned char)i;
+        fragHeader.m_count = (unsigned char)count;
+        memcpy(&fragment[MESSAGE_HEADER_LEN], &fragHeader, FRAGMENT_HEADER_LEN);
+        memcpy(&fragment[MESSAGE_HEADER_LEN + FRAGMENT_HEADER_LEN], msg.data() + offset, dataLen);
+        fragments.push_back(std::move(fragment));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void FragmentReassembler::Reset()
+{
+    for (FragmentGroup& group : m_groups) {
+        group = FragmentGroup();
+    }
+    m_recentCount = 0;
+    m_nextRecent = 0;
+    m_stats = FragmentStats();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// return true when content completes a message, written to message
+bool FragmentReassembler::ReceiveFragment(std::string_view content, double now, std::string& message)
+{
+    RemoveExpired(now);
+
+    NetFragmentHeader header;
+    if (content.size() < (size_t)FRAGMENT_HEADER_LEN) {
+        m_stats.invalidFragments++;
+        return false;
+    }
+    memcpy(&header, content.data(), FRAGMENT_HEADER_LEN);
+    std::string_view data = content.substr(FRAGMENT_HEADER_LEN);
+
+    //only the last fragment may be short
+    bool isLast = header.m_index + 1 == header.m_count;
+    if (header.m_count == 0 || header.m_count > MAX_FRAGMENT_COUNT || header.m_index >= header.m_count ||
+        data.size() > (size_t)FRAGMENT_DATA_LEN || (!isLast && data.size() != (size_t)FRAGMENT_DATA_LEN)) {
+        m_stats.invalidFragments++;
+        return false;
+    }
+
+    m_stats.receivedFragments++;
+    if (IsRecentlyCompleted(header.m_group)) {
+        m_stats.duplicateFragments++;
+        return false;
+    }
+
+    FragmentGroup* group = FindOrAddGroup(header, now);
+    if (group == nullptr) {
+        m_stats.invalidFragments++;
+        return false;
+    }
+
+    group->lastReceiveTime = now;
+    unsigned long long bit = 1ull << header.m_index;
+    if (group->receivedMask & bit) {
+        m_stats.duplicateFragments++;
+        return false;
+    }
+
+    group->receivedMask |= bit;
+    group->receivedCount++;
+    memcpy(&group->data[(size_t)header.m_index * FRAGMENT_DATA_LEN], data.data(), data.size());
+    if (isLast) {
+        group->lastFragmentLen = data.size();
+    }
+
+    int pendingBytes = GetPendingBytes();
+    m_stats.maxPendingBytes = pendingBytes > m_stats.maxPendingBytes ? pendingBytes : m_stats.maxPendingBytes;
+
+    if (group->receivedCount < group->count) {
+        return false;
+    }
+
+    message.assign(group->data.data(), (size_t)(group->count - 1) * FRAGMENT_DATA_LEN + group->lastFragmentLen);
+    m_stats.completedMessages++;
+    MarkCompleted(*group);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void FragmentReassembler::RemoveExpired(double now)
+{
+    for (FragmentGroup& group : m_groups) {
+        if (group.isInUse && now - group.lastReceiveTime > FRAGMENT_TIMEOUT_SECONDS) {
+            group.isInUse = false;
+            group.data.clear();
+            m_stats.timedOutMessages++;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+int FragmentReassembler::GetPendingCount() const
+{
+    int count = 0;
+    for (FragmentGroup const& group : m_groups) {
+        count += group.isInUse ? 1 : 0;
+    }
+    return count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+int FragmentReassembler::GetPendingBytes() const
+{
+    int bytes = 0;
+    for (FragmentGroup const& group : m_groups) {
+        bytes += group.isInUse ? (int)group.data.size() : 0;
+    }
+    return bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// full table evicts the group heard from least recently
+FragmentGroup* FragmentReassembler::FindOrAddGroup(NetFragmentHeader const& header, double now)
+{
+    FragmentGroup* freeGroup = nullptr;
+    FragmentGroup* oldestGroup = nullptr;
+    for (FragmentGroup& group : m_groups) {
+        if (!group.isInUse) {
+            freeGroup = freeGroup ? freeGroup : &group;
+            continue;
+        }
+        if (group.group == header.m_group) {
+            return group.count == header.m_count ? &group : nullptr;
+        }
+        if (oldestGroup == nullptr || group.lastReceiveTime < oldestGroup->lastReceiveTime) {
+            oldestGroup = &group;
+        }
+    }
+
+    FragmentGroup* newGroup = freeGroup;
+    if (newGroup == nullptr) {
+        newGroup = oldestGroup;
+        m_stats.evictedMessages++;
+    }
+
+    newGroup->isInUse = true;
+    newGroup->group = header.m_group;
+    newGroup->count = header.m_count;
+    newGroup->receivedCount = 0;
+    newGroup->receivedMask = 0;
+    newGroup->lastFragmentLen = 0;
+    newGroup->lastReceiveTime = now;
+    newGroup->data.assign((size_t)header.m_count * FRAGMENT_DATA_LEN, '\0');
+    return newGroup;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool FragmentReassembler::IsRecentlyCompleted(unsigned short group) const
+{
+    for (int i = 0; i < m_recentCount; i++) {
+        if (m_recentGroups[i] == group) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void FragmentReassembler::MarkCompleted(FragmentGroup& group)
+{
+    m_recentGroups[m_nextRecent] = group.group;
+    m_nextRecent = (m_nextRecent + 1) % RECENT_FRAGMENT_GROUPS;
+    m_recentCount = m_recentCount < RECENT_FRAGMENT_GROUPS ? m_recentCount + 1 : RECENT_FRAGMENT_GROUPS;
+
+    group.isInUse = false;
+    group.data.clear();
+}
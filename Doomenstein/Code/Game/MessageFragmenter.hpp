@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Game/NetConnection.hpp"
+#include "Game/NetworkMessage.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// binary prefix of every MESSAGE_FRAGMENT content
+struct NetFragmentHeader
+{
+    unsigned short m_group = 0;     //per sender id of the split message
+    unsigned char m_index = 0;
+    unsigned char m_count = 0;
+};
+
+constexpr int FRAGMENT_HEADER_LEN = (int)sizeof(NetFragmentHeader);
+constexpr int FRAGMENT_DATA_LEN = PACKET_MAX_CONTENT_LEN - MESSAGE_HEADER_LEN - FRAGMENT_HEADER_LEN;
+constexpr int MAX_FRAGMENT_COUNT = 64;          //fits the received bit mask
+constexpr int MAX_FRAGMENT_GROUPS = 8;          //messages reassembled at once per connection
+constexpr int RECENT_FRAGMENT_GROUPS = 16;      //completed groups remembered to drop late duplicates
+constexpr double FRAGMENT_TIMEOUT_SECONDS = 2.0;    //since last fragment of the group, sender resends whole reliable groups this often
+
+bool IsMessageOversized(std::string const& msg);
+bool MakeFragmentMessages(std::string const& msg, unsigned short group, std::vector<std::string>& fragments);
+
+//////////////////////////////////////////////////////////////////////////
+struct FragmentGroup
+{
+    bool isInUse = false;
+    unsigned short group = 0;
+    int count = 0;
+    int receivedCount = 0;
+    unsigned long long receivedMask = 0;
+    size_t lastFragmentLen = 0;
+    double lastReceiveTime = 0.0;     //reliable groups stay alive while the sender resends
+    std::string data;
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct FragmentStats
+{
+    int receivedFragments = 0;
+    int completedMessages = 0;
+    int timedOutMessages = 0;
+    int evictedMessages = 0;        //dropped to make room for a newer group
+    int duplicateFragments = 0;
+    int invalidFragments = 0;
+    int maxPendingBytes = 0;
+};
+
+// per connection reassembly of fragmented messages, fixed number of groups bounds memory
+class FragmentReassembler
+{
+public:
+    void Reset();
+
+    bool ReceiveFragment(std::string_view content, double now, std::string& message);
+    void RemoveExpired(double now);
+
+    int GetPendingCount() const;
+    int GetPendingBytes() const;
+    FragmentStats const& GetStats() const {return m_stats;}
+
+private:
+    FragmentGroup* FindOrAddGroup(NetFragmentHeader const& header, double now);
+    bool IsRecentlyCompleted(unsigned short group) const;
+    void MarkCompleted(FragmentGroup& group);
+
+private:
+    FragmentGroup m_groups[MAX_FRAGMENT_GROUPS];
+    unsigned short m_recentGroups[RECENT_FRAGMENT_GROUPS] = {};
+    int m_recentCount = 0;
+    int m_nextRecent = 0;
+    FragmentStats m_stats;
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "Game/NetBufferReader.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/NetConnection.hpp"
+
+#include <charconv>
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////
+NetPacketReader::NetPacketReader(char const* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetPacketReader::ReadPacketHeader(NetPacketHeader& header)
+{
+    if (m_hasError || m_size - m_cursor < (size_t)PACKET_HEADER_LEN) {
+        m_hasError = true;
+        return false;
+    }
+
+    memcpy(&header, m_data + m_cursor, PACKET_HEADER_LEN);
+    m_cursor += PACKET_HEADER_LEN;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetPacketReader::ReadMessage(NetMessageHeader& header, std::string_view& content)
+{
+    if (m_hasError || IsAtEnd()) {
+        return false;
+    }
+
+    if (m_size - m_cursor < (size_t)MESSAGE_HEADER_LEN) {
+        m_hasError = true;
+        return false;
+    }
+
+    memcpy(&header, m_data + m_cursor, MESSAGE_HEADER_LEN);
+    size_t contentStart = m_cursor + MESSAGE_HEADER_LEN;
+    if (m_size - contentStart < (size_t)header.m_size) {
+        m_hasError = true;
+        return false;
+    }
+
+    content = std::string_view(m_data + contentStart, header.m_size);
+    m_cursor = contentStart + header.m_size;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+NetMessageReader::NetMessageReader(std::string_view content)
+    : m_content(content)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetMessageReader::ReadToken(std::string_view& token, char delimiter)
+{
+    if (IsAtEnd()) {
+        return false;
+    }
+
+    size_t end = m_content.find(delimiter, m_cursor);
+    if (end == std::string_view::npos) {
+        end = m_content.size();
+    }
+
+    token = m_content.substr(m_cursor, end - m_cursor);
+    m_cursor = end + 1;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetMessageReader::ReadInt(int& value, char delimiter)
+{
+    std::string_view token;
+    if (!ReadToken(token, delimiter)) {
+        return false;
+    }
+
+    std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetMessageReader::ReadUnsigned(unsigned long long& value, char delimiter)
+{
+    std::string_view token;
+    if (!ReadToken(token, delimiter)) {
+        return false;
+    }
+
+    std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetMessageReader::ReadFloat(float& value, char delimiter)
+{
+    std::string_view token;
+    if (!ReadToken(token, delimiter)) {
+        return false;
+    }
+
+    std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetMessageReader::ReadDouble(double& value, char delimiter)
+{
+    std::string_view token;
+    if (!ReadToken(token, delimiter)) {
+        return false;
+    }
+
+    std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string_view>
+
+struct NetMessageHeader;
+struct NetPacketHeader;
+
+//////////////////////////////////////////////////////////////////////////
+// cursor over a received packet, no copies, every read bounds checked
+class NetPacketReader
+{
+public:
+    NetPacketReader(char const* data, size_t size);
+
+    bool ReadPacketHeader(NetPacketHeader& header);
+    bool ReadMessage(NetMessageHeader& header, std::string_view& content);
+
+    bool IsAtEnd() const {return m_cursor >= m_size;}
+    bool HasError() const {return m_hasError;}
+
+private:
+    char const* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_cursor = 0;
+    bool m_hasError = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// cursor over delimited text message content, no allocations
+class NetMessageReader
+{
+public:
+    explicit NetMessageReader(std::string_view content);
+
+    bool ReadToken(std::string_view& token, char delimiter = ';');
+    bool ReadInt(int& value, char delimiter = ';');
+    bool ReadUnsigned(unsigned long long& value, char delimiter = ';');
+    bool ReadFloat(float& value, char delimiter = ';');
+    bool ReadDouble(double& value, char delimiter = ';');
+
+    bool IsAtEnd() const {return m_cursor > m_content.size();}
+    std::string_view GetContent() const {return m_content;}
+
+private:
+    std::string_view m_content;
+    size_t m_cursor = 0;
+};
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "Game/NetCompression.hpp"
+#include "Engine/Core/Time.hpp"
+
+#include <cstring>
+
+static CompressionStats sStats;
+static std::vector<std::string> sCapturedPackets;
+static int sCaptureRemaining = 0;
+
+//////////////////////////////////////////////////////////////////////////
+static unsigned int ReadU32(char const* src)
+{
+    unsigned int value = 0;
+    memcpy(&value, src, 4);
+    return value;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static int HashU32(unsigned int value)
+{
+    return (int)((value * 2654435761u) >> (32 - COMPRESS_HASH_BITS));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// lengths of 15 or more continue in following bytes, 255 means keep reading
+static void WriteLengthTail(std::string& dst, size_t length)
+{
+    while (length >= 255) {
+        dst += (char)255;
+        length -= 255;
+    }
+    dst += (char)length;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static bool ReadLengthTail(unsigned char const*& ip, unsigned char const* end, size_t& length)
+{
+    unsigned char b = 255;
+    while (b == 255) {
+        if (ip >= end) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static void WriteSequence(std::string& dst, char const* literals, size_t literalLen, size_t offset, size_t matchLen)
+{
+    size_t matchCode = matchLen > 0 ? matchLen - COMPRESS_MIN_MATCH : 0;
+    unsigned char token = (unsigned char)(((literalLen < 15 ? literalLen : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    dst += (char)token;
+    if (literalLen >= 15) {
+        WriteLengthTail(dst, literalLen - 15);
+    }
+    dst.append(literals, literalLen);
+
+    if (matchLen == 0) {
+        return;
+    }
+    dst += (char)(offset & 0xff);
+    dst += (char)(offset >> 8);
+    if (matchCode >= 15) {
+        WriteLengthTail(dst, matchCode - 15);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CompressBytes(char const* src, size_t srcLen, std::string& dst)
+{
+    dst.clear();
+    int table[1 << COMPRESS_HASH_BITS];
+    memset(table, 0xff, sizeof(table));
+
+    size_t ip = 0;
+    size_t anchor = 0;
+    while (ip + COMPRESS_MIN_MATCH <= srcLen) {
+        unsigned int sequence = ReadU32(src + ip);
+        int hash = HashU32(sequence);
+        int ref = table[hash];
+        table[hash] = (int)ip;
+        if (ref < 0 || ip - (size_t)ref > COMPRESS_MAX_OFFSET || ReadU32(src + ref) != sequence) {
+            ip++;
+            continue;
+        }
+
+        size_t matchLen = COMPRESS_MIN_MATCH;
+        while (ip + matchLen < srcLen && src[ref + matchLen] == src[ip + matchLen]) {
+            matchLen++;
+        }
+        WriteSequence(dst, src + anchor, ip - anchor, ip - (size_t)ref, matchLen);
+        ip += matchLen;
+        anchor = ip;
+    }
+
+    if (anchor < srcLen) {
+        WriteSequence(dst, src + anchor, srcLen - anchor, 0, 0);
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// every length and offset checked, corrupt input fails instead of overrunning
+bool DecompressBytes(char const* src, size_t srcLen, std::string& dst, size_t maxDstLen)
+{
+    dst.clear();
+    unsigned char const* ip = reinterpret_cast<unsigned char const*>(src);
+    unsigned char const* end = ip + srcLen;
+    while (ip < end) {
+        unsigned char token = *ip++;
+        size_t literalLen = token >> 4;
+        if (literalLen == 15 && !ReadLengthTail(ip, end, literalLen)) {
+            return false;
+        }
+        if ((size_t)(end - ip) < literalLen || dst.size() + literalLen > maxDstLen) {
+            return false;
+        }
+        dst.append(reinterpret_cast<char const*>(ip), literalLen);
+        ip += literalLen;
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !ReadLengthTail(ip, end, matchLen)) {
+            return false;
+        }
+        matchLen += COMPRESS_MIN_MATCH;
+        if (offset == 0 || offset > dst.size() || dst.size() + matchLen > maxDstLen) {
+            return false;
+        }
+
+        //byte by byte, matches may overlap their own output
+        size_t from = dst.size() - offset;
+        for (size_t i = 0; i < matchLen; i++) {
+            dst += dst[from + i];
+        }
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool CompressPacketContent(char const* content, size_t contentLen, std::string& dst)
+{
+    if (contentLen < (size_t)COMPRESS_MIN_CONTENT_LEN) {
+        return false;
+    }
+
+    double startSeconds = GetCurrentTimeSeconds();
+    CompressBytes(content, contentLen, dst);
+    sStats.compressSeconds += GetCurrentTimeSeconds() - startSeconds;
+    sStats.consideredPackets++;
+    if (dst.size() >= contentLen) {
+        return false;
+    }
+
+    sStats.compressedPackets++;
+    sStats.rawBytes += (long long)contentLen;
+    sStats.compressedBytes += (long long)dst.size();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool DecompressPacketContent(char const* content, size_t contentLen, std::string& dst, size_t maxDstLen)
+{
+    double startSeconds = GetCurrentTimeSeconds();
+    bool isValid = DecompressBytes(content, contentLen, dst, maxDstLen);
+    sStats.decompressSeconds += GetCurrentTimeSeconds() - startSeconds;
+    if (!isValid) {
+        sStats.failedPackets++;
+        return false;
+    }
+
+    sStats.decompressedPackets++;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void CapturePacketContent(char const* content, size_t contentLen)
+{
+    if (sCaptureRemaining <= 0) {
+        return;
+    }
+
+    sCapturedPackets.push_back(std::string(content, contentLen));
+    sCaptureRemaining--;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void StartPacketCapture(int packetCount)
+{
+    sCapturedPackets.clear();
+    sCaptureRemaining = packetCount < MAX_CAPTURED_PACKETS ? packetCount : MAX_CAPTURED_PACKETS;
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::vector<std::string> const& GetCapturedPackets()
+{
+    return sCapturedPackets;
+}
+
+//////////////////////////////////////////////////////////////////////////
+CompressionStats const& GetCompressionStats()
+{
+    return sStats;
+}
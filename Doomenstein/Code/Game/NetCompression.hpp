@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+constexpr int COMPRESS_MIN_CONTENT_LEN = 64;    //smaller packets rarely shrink
+constexpr int COMPRESS_MIN_MATCH = 4;
+constexpr int COMPRESS_HASH_BITS = 12;
+constexpr int COMPRESS_MAX_OFFSET = 65535;
+constexpr int MAX_CAPTURED_PACKETS = 1024;
+
+//////////////////////////////////////////////////////////////////////////
+struct CompressionStats
+{
+    long long consideredPackets = 0;
+    long long compressedPackets = 0;
+    long long decompressedPackets = 0;
+    long long failedPackets = 0;        //corrupt compressed payloads received
+    long long rawBytes = 0;             //content bytes of compressed packets before
+    long long compressedBytes = 0;      //and after
+    double compressSeconds = 0.0;
+    double decompressSeconds = 0.0;
+};
+
+// lz4 style byte codec, token of literal and match lengths, then literals,
+// then 2 byte offset back into output; no dictionary, no checksum
+bool CompressBytes(char const* src, size_t srcLen, std::string& dst);
+bool DecompressBytes(char const* src, size_t srcLen, std::string& dst, size_t maxDstLen);
+
+// packet level, false if compressing does not shrink content
+bool CompressPacketContent(char const* content, size_t contentLen, std::string& dst);
+bool DecompressPacketContent(char const* content, size_t contentLen, std::string& dst, size_t maxDstLen);
+
+void CapturePacketContent(char const* content, size_t contentLen);
+void StartPacketCapture(int packetCount);
+std::vector<std::string> const& GetCapturedPackets();
+
+CompressionStats const& GetCompressionStats();
\ No newline at end of file
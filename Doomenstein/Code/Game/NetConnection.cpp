@@ -0,0 +1,147 @@
+#include "Game/NetConnection.hpp"
+
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////
+void NetConnection::Reset()
+{
+    m_localSeq = 0;
+    m_remoteSeq = 0;
+    m_remoteSeqReceiveTime = 0.0;
+    m_remoteAckBits = 0;
+    m_hasReceived = false;
+    m_nextReliableId = 0;
+    m_lossCheckSeq = 0;
+    m_stats = ConnectionStats();
+    m_sentPackets.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// unacked reliables wait this long before going out again, zero until rtt is measured
+float NetConnection::GetResendTimeout() const
+{
+    if (m_stats.rttSamples == 0) {
+        return 0.f;
+    }
+    float timeout = m_stats.rtt + 4.f * m_stats.rttVar;
+    return timeout < MAX_RESEND_TIMEOUT_SECONDS ? timeout : MAX_RESEND_TIMEOUT_SECONDS;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// send time is when the packet leaves, after pacing, so neither rtt nor hold time count it
+void NetConnection::WritePacketHeader(std::vector<unsigned short> const& reliableIds, double sendTime, NetPacketHeader& header)
+{
+    unsigned short seq = m_localSeq++;
+    SentPacketData* sent = m_sentPackets.Insert(seq);
+    sent->reliableIds = reliableIds;
+    sent->sendTime = sendTime;
+    m_stats.sentPackets++;
+
+    //acks only leave with the next send, peer takes that wait off its sample
+    double ackDelay = m_hasReceived && sendTime > m_remoteSeqReceiveTime ? sendTime - m_remoteSeqReceiveTime : 0.0;
+    header.m_seq = seq;
+    header.m_ack = m_remoteSeq;
+    header.m_ackBits = m_hasReceived ? m_remoteAckBits : 0;
+    header.m_ackDelayMicros = (unsigned int)(ackDelay * 1000000.0);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// return false if packet is a duplicate
+bool NetConnection::ReceivePacketHeader(NetPacketHeader const& header, double receiveTime, std::vector<unsigned short>& ackedReliableIds)
+{
+    //acks from remote, only the newest one has a known hold time to sample rtt with
+    AckSentPacket(header.m_ack, receiveTime, (double)header.m_ackDelayMicros / 1000000.0, true, ackedReliableIds);
+    for (int i = 0; i < ACK_BITS_COUNT; i++) {
+        if (header.m_ackBits & (1u << i)) {
+            AckSentPacket((unsigned short)(header.m_ack - 1 - i), receiveTime, 0.0, false, ackedReliableIds);
+        }
+    }
+    DetectLostPackets(header.m_ack);
+
+    //record received for own acks
+    unsigned short seq = header.m_seq;
+    if (!m_hasReceived) {
+        m_hasReceived = true;
+        m_remoteSeq = seq;
+        m_remoteSeqReceiveTime = receiveTime;
+        m_remoteAckBits = 0;
+        return true;
+    }
+
+    if (IsSequenceGreaterThan(seq, m_remoteSeq)) {
+        int shift = (unsigned short)(seq - m_remoteSeq);
+        if (shift > ACK_BITS_COUNT) {
+            m_remoteAckBits = 0;
+        }
+        else if (shift == ACK_BITS_COUNT) {
+            m_remoteAckBits = 1u << (ACK_BITS_COUNT - 1);
+        }
+        else {
+            m_remoteAckBits = (m_remoteAckBits << shift) | (1u << (shift - 1));
+        }
+        m_remoteSeq = seq;
+        m_remoteSeqReceiveTime = receiveTime;
+        return true;
+    }
+
+    int diff = (unsigned short)(m_remoteSeq - seq);
+    if (diff == 0) {
+        return false;
+    }
+    if (diff <= ACK_BITS_COUNT) {
+        unsigned int bit = 1u << (diff - 1);
+        if (m_remoteAckBits & bit) {
+            return false;
+        }
+        m_remoteAckBits |= bit;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ack delay is how long the peer held the ack, a round trip is the rest
+void NetConnection::AckSentPacket(unsigned short seq, double ackTime, double ackDelay, bool isRttSample, std::vector<unsigned short>& ackedReliableIds)
+{
+    SentPacketData* sent = m_sentPackets.Find(seq);
+    if (sent == nullptr || sent->isAcked) {
+        return;
+    }
+
+    sent->isAcked = true;
+    ackedReliableIds.insert(ackedReliableIds.end(), sent->reliableIds.begin(), sent->reliableIds.end());
+    m_stats.lossRate *= 1.f - LOSS_EWMA_ALPHA;
+    m_stats.ackedPackets++;
+    if (!isRttSample) {
+        return;
+    }
+
+    //rtt and jitter smoothing as in tcp
+    double roundTrip = ackTime - sent->sendTime - ackDelay;
+    float sample = roundTrip > 0.0 ? (float)roundTrip : 0.f;
+    if (m_stats.rttSamples == 0) {
+        m_stats.rtt = sample;
+        m_stats.rttVar = sample * .5f;
+        m_stats.minRtt = sample;
+    }
+    else {
+        m_stats.rttVar = .75f * m_stats.rttVar + .25f * fabsf(m_stats.rtt - sample);
+        m_stats.rtt = .875f * m_stats.rtt + .125f * sample;
+        m_stats.minRtt = sample < m_stats.minRtt ? sample : m_stats.minRtt;
+    }
+    m_stats.rttSamples++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// packets falling out of remote ack window unacked are lost
+void NetConnection::DetectLostPackets(unsigned short remoteAck)
+{
+    unsigned short windowStart = (unsigned short)(remoteAck - ACK_BITS_COUNT);
+    while (m_lossCheckSeq != m_localSeq && IsSequenceGreaterThan(windowStart, m_lossCheckSeq)) {
+        SentPacketData* sent = m_sentPackets.Find(m_lossCheckSeq);
+        if (sent && !sent->isAcked) {
+            m_stats.lostPackets++;
+            m_stats.lossRate = m_stats.lossRate * (1.f - LOSS_EWMA_ALPHA) + LOSS_EWMA_ALPHA;
+        }
+        m_lossCheckSeq++;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Game/SequenceBuffer.hpp"
+#include "Engine/Network/NetworkCommon.hpp"
+#include <string>
+#include <vector>
+
+constexpr int SENT_PACKET_BUFFER_SIZE = 256;
+constexpr int ACK_BITS_COUNT = 32;
+constexpr float LOSS_EWMA_ALPHA = .1f;
+constexpr float MAX_RESEND_TIMEOUT_SECONDS = 1.f;
+
+//////////////////////////////////////////////////////////////////////////
+// prefix of every text package content, acks piggybacked on all traffic
+struct NetPacketHeader
+{
+    unsigned short m_seq = 0;
+    unsigned short m_ack = 0;
+    unsigned int m_ackBits = 0;     //bit i set: packet (m_ack-1-i) received
+    unsigned int m_serverTick = 0;  //latest server simulation tick known to sender
+    unsigned int m_flags = 0;       //ePacketFlag bits
+    unsigned int m_ackDelayMicros = 0;  //m_ack was held this long before this packet, taken off the rtt sample
+};
+
+//////////////////////////////////////////////////////////////////////////
+enum ePacketFlag : unsigned int
+{
+    PACKET_FLAG_COMPRESSED = 1 << 0,    //messages after this header are NetCompression encoded
+};
+
+constexpr int PACKET_HEADER_LEN = (int)sizeof(NetPacketHeader);
+constexpr int PACKET_MAX_CONTENT_LEN = NET_MAX_DATA_LEN - PACKET_HEADER_LEN;
+constexpr int PACKET_PREFIX_LEN = NET_HEADER_LEN + PACKET_HEADER_LEN;
+
+//////////////////////////////////////////////////////////////////////////
+struct SentPacketData
+{
+    std::vector<unsigned short> reliableIds;
+    double sendTime = 0.0;
+    bool isAcked = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct ConnectionStats
+{
+    float rtt = 0.f;            //smoothed, seconds
+    float rttVar = 0.f;         //jitter
+    float minRtt = 0.f;
+    float lossRate = 0.f;       //smoothed fraction of packets lost
+    long long sentPackets = 0;
+    long long ackedPackets = 0;
+    long long rttSamples = 0;   //acks that carried their hold time
+    long long lostPackets = 0;
+};
+
+// per connection packet sequencing and acks
+class NetConnection
+{
+public:
+    void Reset();
+
+    void WritePacketHeader(std::vector<unsigned short> const& reliableIds, double sendTime, NetPacketHeader& header);
+    bool ReceivePacketHeader(NetPacketHeader const& header, double receiveTime, std::vector<unsigned short>& ackedReliableIds);
+
+    unsigned short GetNextReliableId() {return m_nextReliableId++;}
+    float GetResendTimeout() const;
+    ConnectionStats const& GetStats() const {return m_stats;}
+
+private:
+    void AckSentPacket(unsigned short seq, double ackTime, double ackDelay, bool isRttSample, std::vector<unsigned short>& ackedReliableIds);
+    void DetectLostPackets(unsigned short remoteAck);
+
+private:
+    unsigned short m_localSeq = 0;
+    unsigned short m_remoteSeq = 0;
+    double m_remoteSeqReceiveTime = 0.0;    //hold time of the next ack counts from here
+    unsigned int m_remoteAckBits = 0;
+    bool m_hasReceived = false;
+    unsigned short m_nextReliableId = 0;
+    unsigned short m_lossCheckSeq = 0;     //oldest sent packet not yet acked or lost
+
+    ConnectionStats m_stats;
+    SequenceBuffer<SentPacketData, SENT_PACKET_BUFFER_SIZE> m_sentPackets;
+};
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "Game/NetIOThread.hpp"
+#include "Game/NetTransport.hpp"
+#include "Engine/Core/Time.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+// later release on top, equal times keep queue order
+static bool IsReleasedAfter(OutgoingPacket const& a, OutgoingPacket const& b)
+{
+    if (a.releaseTime != b.releaseTime) {
+        return a.releaseTime > b.releaseTime;
+    }
+    return a.order > b.order;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetIOThread::Startup()
+{
+    m_isRunning = true;
+    m_thread = std::thread(&NetIOThread::ThreadMain, this);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// queued packets are still sent before thread exits
+void NetIOThread::Shutdown()
+{
+    if (!m_isRunning) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_isRunning = false;
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+
+    //parked when ring was full at exit, leave in order from here
+    for (OutgoingPacket const& parked : m_overflow) {
+        parked.transport->Send(parked.data);
+    }
+    m_overflow.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// main thread only, never blocks on the socket
+// release time 0 sends as soon as the thread wakes
+// a full ring parks packets on the main thread, they still go out in order through the thread
+void NetIOThread::QueuePacket(NetTransport* transport, std::string const& packet, double releaseTime)
+{
+    //no thread before startup or after shutdown
+    if (!m_isRunning) {
+        transport->Send(packet);
+        return;
+    }
+
+    double queueTime = GetCurrentTimeSeconds();
+    m_queuedPackets++;
+    DrainOverflow();
+    if (m_overflow.empty() && PushToRing(transport, packet, queueTime, releaseTime)) {
+        return;
+    }
+
+    m_overflow.emplace_back();
+    OutgoingPacket& parked = m_overflow.back();
+    parked.transport = transport;
+    parked.data.assign(packet);
+    parked.queueTime = queueTime;
+    parked.releaseTime = releaseTime;
+    m_overflowPackets++;
+    m_maxOverflowDepth = (int)m_overflow.size() > m_maxOverflowDepth ? (int)m_overflow.size() : m_maxOverflowDepth;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// end of frame, one wake for everything queued since last submit instead of one per packet
+void NetIOThread::SubmitBatch()
+{
+    m_submittedBatches++;
+    DrainOverflow();
+    Wake();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// wait until every queued packet left, call before stopping a socket
+// held packets go out right away instead of at their paced time
+void NetIOThread::Flush()
+{
+    m_isFlushing = true;
+    do {
+        DrainOverflow();
+        Wake();
+        while (m_isRunning && m_pendingPackets > 0 && (m_overflow.empty() || m_outgoing.GetSize() >= NET_IO_QUEUE_SIZE)) {
+            std::this_thread::yield();
+        }
+    } while (m_isRunning && (m_pendingPackets > 0 || !m_overflow.empty()));
+    m_isFlushing = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// false if ring is full
+bool NetIOThread::PushToRing(NetTransport* transport, std::string const& packet, double queueTime, double releaseTime)
+{
+    OutgoingPacket* slot = m_outgoing.BeginPush();
+    if (slot == nullptr) {
+        return false;
+    }
+
+    slot->transport = transport;
+    slot->data.assign(packet);
+    slot->queueTime = queueTime;
+    slot->releaseTime = releaseTime;
+    m_pendingPackets++;
+    m_outgoing.EndPush();
+
+    int depth = m_outgoing.GetSize();
+    m_maxQueueDepth = depth > m_maxQueueDepth ? depth : m_maxQueueDepth;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetIOThread::DrainOverflow()
+{
+    while (!m_overflow.empty()) {
+        OutgoingPacket const& parked = m_overflow.front();
+        if (!PushToRing(parked.transport, parked.data, parked.queueTime, parked.releaseTime)) {
+            return;
+        }
+        m_overflow.pop_front();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// lock taken so a thread about to wait sees the new state instead of missing the notify
+void NetIOThread::Wake()
+{
+    if (m_pendingPackets > 0 || m_isFlushing) {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+        }
+        m_wakeCalls++;
+        m_wakeCondition.notify_one();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+NetIOStats NetIOThread::GetStats() const
+{
+    NetIOStats stats;
+    stats.queuedPackets = m_queuedPackets;
+    stats.overflowPackets = m_overflowPackets;
+    stats.maxOverflowDepth = m_maxOverflowDepth;
+    stats.maxQueueDepth = m_maxQueueDepth;
+    stats.sentPackets = m_sentPackets;
+    stats.sendSeconds = (double)m_sendMicroseconds * .000001;
+    stats.maxQueueSeconds = (double)m_maxQueueMicroseconds * .000001;
+    stats.submittedBatches = m_submittedBatches;
+    stats.wakeCalls = m_wakeCalls;
+    stats.sentBatches = m_sentBatches;
+    stats.threadWakeups = m_threadWakeups;
+    stats.maxBatchSize = m_maxBatchSize;
+    stats.totalQueueSeconds = (double)m_totalQueueMicroseconds * .000001;
+    stats.maxLateSeconds = (double)m_maxLateMicroseconds * .000001;
+    stats.maxHeldPackets = m_maxHeldPackets;
+    return stats;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetIOThread::ThreadMain()
+{
+    for (;;) {
+        HoldQueuedPackets();
+
+        double startSeconds = GetCurrentTimeSeconds();
+        bool isFlushing = m_isFlushing || !m_isRunning;
+        int batchSize = 0;
+        while (batchSize < NET_IO_MAX_BATCH && !m_held.empty()) {
+            OutgoingPacket& packet = m_held.front();
+            if (!isFlushing && packet.releaseTime > startSeconds) {
+                break;
+            }
+
+            long long queueMicroseconds = (long long)((startSeconds - packet.queueTime) * 1000000.0);
+            m_totalQueueMicroseconds += queueMicroseconds;
+            if (queueMicroseconds > m_maxQueueMicroseconds) {
+                m_maxQueueMicroseconds = queueMicroseconds;
+            }
+            long long lateMicroseconds = (long long)((startSeconds - packet.releaseTime) * 1000000.0);
+            if (packet.releaseTime > 0.0 && lateMicroseconds > m_maxLateMicroseconds) {
+                m_maxLateMicroseconds = lateMicroseconds;
+            }
+
+            packet.transport->Send(packet.data);
+            std::pop_heap(m_held.begin(), m_held.end(), IsReleasedAfter);
+            m_spareBuffers.push_back(std::move(m_held.back().data));
+            m_held.pop_back();
+            m_pendingPackets--;
+            batchSize++;
+        }
+
+        if (batchSize > 0) {
+            m_sentPackets += batchSize;
+            m_sentBatches++;
+            if (batchSize > m_maxBatchSize) {
+                m_maxBatchSize = batchSize;
+            }
+            m_sendMicroseconds += (long long)((GetCurrentTimeSeconds() - startSeconds) * 1000000.0);
+            continue;
+        }
+
+        if (!m_isRunning && m_held.empty()) {
+            return;
+        }
+        WaitForWork();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ring slots swap storage with spare buffers, so holding allocates nothing once warm
+void NetIOThread::HoldQueuedPackets()
+{
+    for (;;) {
+        OutgoingPacket* queued = m_outgoing.BeginPop();
+        if (queued == nullptr) {
+            break;
+        }
+
+        m_held.emplace_back();
+        OutgoingPacket& held = m_held.back();
+        if (!m_spareBuffers.empty()) {
+            held.data = std::move(m_spareBuffers.back());
+            m_spareBuffers.pop_back();
+        }
+        held.data.swap(queued->data);
+        held.transport = queued->transport;
+        held.queueTime = queued->queueTime;
+        held.releaseTime = queued->releaseTime;
+        held.order = m_nextOrder++;
+        m_outgoing.EndPop();
+        std::push_heap(m_held.begin(), m_held.end(), IsReleasedAfter);
+    }
+
+    if ((int)m_held.size() > m_maxHeldPackets) {
+        m_maxHeldPackets = (int)m_held.size();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// sleep until next release time, with nothing held sleep until woken, no idle polling
+void NetIOThread::WaitForWork()
+{
+    double dueSeconds = m_held.empty() ? 0.0 : m_held.front().releaseTime - GetCurrentTimeSeconds();
+    if (!m_held.empty() && dueSeconds <= NET_IO_SPIN_SECONDS) {
+        std::this_thread::yield();
+        return;
+    }
+
+    auto hasWork = [this]() {return m_outgoing.GetSize() > 0 || !m_isRunning || (m_isFlushing && !m_held.empty());};
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    if (m_held.empty()) {
+        m_wakeCondition.wait(lock, hasWork);
+    }
+    else {
+        m_wakeCondition.wait_for(lock, std::chrono::microseconds((long long)((dueSeconds - NET_IO_SPIN_SECONDS) * 1000000.0)), hasWork);
+    }
+    m_threadWakeups++;
+}
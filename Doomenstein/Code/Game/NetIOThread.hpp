@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Game/SpscRing.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class NetTransport;
+
+constexpr int NET_IO_QUEUE_SIZE = 256;
+constexpr int NET_IO_MAX_BATCH = 64;     //packets sent per wake before checking queue again
+constexpr double NET_IO_SPIN_SECONDS = .001;    //paced packets due sooner are waited for by yielding, sleeps are too coarse
+
+//////////////////////////////////////////////////////////////////////////
+struct OutgoingPacket
+{
+    NetTransport* transport = nullptr;
+    std::string data;
+    double queueTime = 0.0;
+    double releaseTime = 0.0;   //from the pacer, not sent before
+    long long order = 0;        //io thread only, equal release times keep queue order
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct NetIOStats
+{
+    long long queuedPackets = 0;
+    long long sentPackets = 0;
+    long long overflowPackets = 0;  //waited on main thread for ring space, order and release time kept
+    int maxOverflowDepth = 0;
+    int maxQueueDepth = 0;
+    double sendSeconds = 0.0;       //spent in socket sends on io thread
+    double maxQueueSeconds = 0.0;   //longest wait from queue to send
+    double totalQueueSeconds = 0.0; //over sent packets, pacing included
+    double maxLateSeconds = 0.0;    //longest send after its release time
+    int maxHeldPackets = 0;         //waiting for their release time at once
+
+    long long submittedBatches = 0; //frames handed to io thread, one wake each
+    long long wakeCalls = 0;        //condition notifies issued by main thread
+    long long threadWakeups = 0;    //io thread returns from waiting, woken or due release time
+    long long sentBatches = 0;      //io thread passes that sent at least one packet, one socket send per packet
+    int maxBatchSize = 0;
+};
+
+// owns udp sends off the main thread, frame only copies packets into a ring
+// and wakes the thread once per frame; the thread holds each packet until its
+// paced release time, so a frame's packets leave spread out instead of in one burst
+class NetIOThread
+{
+public:
+    void Startup();
+    void Shutdown();
+
+    void QueuePacket(NetTransport* transport, std::string const& packet, double releaseTime = 0.0);
+    void SubmitBatch();
+    void Flush();
+
+    NetIOStats GetStats() const;
+
+private:
+    void ThreadMain();
+    void HoldQueuedPackets();
+    void WaitForWork();
+    bool PushToRing(NetTransport* transport, std::string const& packet, double queueTime, double releaseTime);
+    void DrainOverflow();
+    void Wake();
+
+private:
+    SpscRing<OutgoingPacket, NET_IO_QUEUE_SIZE> m_outgoing;
+    std::thread m_thread;
+    std::atomic<bool> m_isRunning{false};
+    std::atomic<int> m_pendingPackets{0};   //queued and not yet sent
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_isFlushing{false};    //send held packets now, release times ignored
+
+    //main thread only
+    std::deque<OutgoingPacket> m_overflow;  //ring was full, moved in ahead of any newer packet
+    long long m_queuedPackets = 0;
+    long long m_overflowPackets = 0;
+    int m_maxOverflowDepth = 0;
+    int m_maxQueueDepth = 0;
+    long long m_submittedBatches = 0;
+    long long m_wakeCalls = 0;
+
+    //io thread writes, main reads
+    std::atomic<long long> m_sentPackets{0};
+    std::atomic<long long> m_sendMicroseconds{0};
+    std::atomic<long long> m_maxQueueMicroseconds{0};
+    std::atomic<long long> m_sentBatches{0};
+    std::atomic<long long> m_threadWakeups{0};
+    std::atomic<int> m_maxBatchSize{0};
+    std::atomic<long long> m_totalQueueMicroseconds{0};
+    std::atomic<long long> m_maxLateMicroseconds{0};
+    std::atomic<int> m_maxHeldPackets{0};
+
+    //io thread only
+    std::vector<OutgoingPacket> m_held;     //min heap on release time
+    std::vector<std::string> m_spareBuffers;    //sent packets' storage, reused for held ones
+    long long m_nextOrder = 0;
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "Game/NetPacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////
+// bucket kept as the time it refills, a packet goes once it's within burst of that
+// sends carry more than the rate they are paced at, so no packet waits longer than the max debt
+static double TakeTokens(double& bucketTime, int bytes, float bytesPerSec, float burstBytes, double earliest, double now)
+{
+    double burstSeconds = (double)(burstBytes / bytesPerSec);
+    bucketTime = std::min(bucketTime, now + burstSeconds + NET_PACE_MAX_DEBT_SECONDS);
+    double release = std::max(earliest, bucketTime - burstSeconds);
+    bucketTime = std::max(bucketTime, release) + (double)bytes / (double)bytesPerSec;
+    return release;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetPacer::SetSettings(NetPaceSettings const& settings)
+{
+    m_settings = settings;
+    m_totalBucketTime = 0.0;
+    for (auto& pair : m_connections) {
+        pair.second.bucketTime = 0.0;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// expected time until the next frame hands over more packets
+void NetPacer::SetWindow(float windowSeconds)
+{
+    m_windowSeconds = std::min(std::max(windowSeconds, 0.f), NET_PACE_MAX_WINDOW_SECONDS);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetPacer::ResetStats()
+{
+    m_stats = NetPaceStats();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// bytesPerSec 0 leaves the connection unlimited, only the total bucket applies
+// time critical packets go now, clock sync and handshake measure delay,
+// their bytes are still taken so the packets after them wait instead
+double NetPacer::Schedule(NetTransport* transport, int bytes, float bytesPerSec, double now, bool isTimeCritical)
+{
+    if (!m_settings.isEnabled) {
+        return now;
+    }
+
+    PacedConnection& connection = GetConnection(transport);
+    double slot = isTimeCritical ? now : now + (double)(connection.phase * m_windowSeconds);
+    double release = slot;
+    if (bytesPerSec > 0.f) {
+        release = TakeTokens(connection.bucketTime, bytes, bytesPerSec, m_settings.connectionBurstBytes, release, now);
+    }
+    if (m_settings.totalKbps > 0) {
+        release = TakeTokens(m_totalBucketTime, bytes, (float)m_settings.totalKbps * 125.f, m_settings.totalBurstBytes, release, now);
+    }
+    if (isTimeCritical) {
+        release = now;
+    }
+
+    double delay = release - now;
+    m_stats.scheduledPackets++;
+    m_stats.throttledPackets += release > slot ? 1 : 0;
+    m_stats.totalDelaySeconds += delay;
+    m_stats.maxDelaySeconds = std::max(m_stats.maxDelaySeconds, delay);
+    return release;
+}
+
+//////////////////////////////////////////////////////////////////////////
+float NetPacer::GetPhase(NetTransport* transport)
+{
+    return GetConnection(transport).phase;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetPacer::ForgetTransport(NetTransport* transport)
+{
+    m_connections.erase(transport);
+}
+
+//////////////////////////////////////////////////////////////////////////
+NetPacer::PacedConnection& NetPacer::GetConnection(NetTransport* transport)
+{
+    auto found = m_connections.find(transport);
+    if (found != m_connections.end()) {
+        return found->second;
+    }
+
+    PacedConnection& connection = m_connections[transport];
+    connection.phase = m_nextPhase;
+    m_nextPhase = std::fmod(m_nextPhase + NET_PACE_GOLDEN_RATIO, 1.f);
+    return connection;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <unordered_map>
+
+class NetTransport;
+
+constexpr float NET_PACE_GOLDEN_RATIO = .618034f;      //phase step, keeps connections evenly apart at any count
+constexpr float NET_PACE_MAX_WINDOW_SECONDS = .005f;   //phase adds at most this to one way delay, however long the frame
+constexpr double NET_PACE_MAX_DEBT_SECONDS = .034;     //about one send interval, older debt is forgiven so delay can't build up
+
+//////////////////////////////////////////////////////////////////////////
+struct NetPaceSettings
+{
+    bool isEnabled = true;
+    float connectionBurstBytes = 2400.f;    //back to back before a connection's own rate applies
+    int totalKbps = 0;                      //all connections together, 0 is unlimited
+    float totalBurstBytes = 16000.f;
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct NetPaceStats
+{
+    long long scheduledPackets = 0;
+    long long throttledPackets = 0;         //held past their spread slot by a token bucket
+    double totalDelaySeconds = 0.0;         //release minus schedule time
+    double maxDelaySeconds = 0.0;
+};
+
+// main thread only: hands every packet a release time the io thread waits for.
+// connections start at their own phase of the frame, then each connection and the
+// link as a whole are token buckets so a send's packets trickle out at its rate
+class NetPacer
+{
+public:
+    void SetSettings(NetPaceSettings const& settings);
+    void SetWindow(float windowSeconds);
+    void ResetStats();
+
+    double Schedule(NetTransport* transport, int bytes, float bytesPerSec, double now, bool isTimeCritical = false);
+    float GetPhase(NetTransport* transport);
+    void ForgetTransport(NetTransport* transport);
+
+    float GetWindow() const {return m_windowSeconds;}
+    NetPaceSettings const& GetSettings() const {return m_settings;}
+    NetPaceStats const& GetStats() const {return m_stats;}
+
+private:
+    struct PacedConnection
+    {
+        float phase = 0.f;          //fraction of the window its packets start at
+        double bucketTime = 0.0;    //token bucket as the time it would be full again
+    };
+
+    PacedConnection& GetConnection(NetTransport* transport);
+
+private:
+    NetPaceSettings m_settings;
+    NetPaceStats m_stats;
+    float m_windowSeconds = 0.f;
+    float m_nextPhase = 0.f;
+    double m_totalBucketTime = 0.0;
+    std::unordered_map<NetTransport*, PacedConnection> m_connections;
+};
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "Game/NetSimulator.hpp"
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// later release on top, equal times keep submit order
+static bool IsReleasedAfter(SimulatedPacket const& a, SimulatedPacket const& b)
+{
+    if (a.releaseTime != b.releaseTime) {
+        return a.releaseTime > b.releaseTime;
+    }
+    return a.order > b.order;
+}
+
+//////////////////////////////////////////////////////////////////////////
+NetSimulator::NetSimulator()
+{
+    SetSeed(NET_SIM_DEFAULT_SEED);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// same seed, settings and traffic give the same drops and delays
+void NetSimulator::SetSeed(unsigned int seed)
+{
+    m_seed = seed;
+    m_rng.seed(seed);
+    for (int i = 0; i < NUM_NET_SIM_DIRECTIONS; i++) {
+        m_linkFreeTime[i] = 0.0;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetSimulator::SetSettings(eNetSimDirection direction, NetSimSettings const& settings)
+{
+    m_settings[direction] = settings;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetSimulator::ResetStats()
+{
+    for (int i = 0; i < NUM_NET_SIM_DIRECTIONS; i++) {
+        m_stats[i] = NetSimStats();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetSimulator::Submit(eNetSimDirection direction, NetTransport* transport, std::string const& packet, double now)
+{
+    NetSimSettings const& settings = m_settings[direction];
+    NetSimStats& stats = m_stats[direction];
+    stats.submittedPackets++;
+
+    if (RollPercent(settings.lossPercent)) {
+        stats.lostPackets++;
+        return;
+    }
+
+    //bandwidth serializes packets, backlog beyond max queue is tail dropped
+    double departTime = now;
+    if (settings.bandwidthKbps > 0) {
+        double& linkFreeTime = m_linkFreeTime[direction];
+        departTime = linkFreeTime > now ? linkFreeTime : now;
+        if (departTime - now > NET_SIM_MAX_QUEUE_SECONDS) {
+            stats.overflowPackets++;
+            return;
+        }
+        linkFreeTime = departTime + (double)packet.size() * 8.0 / ((double)settings.bandwidthKbps * 1000.0);
+    }
+
+    int copies = RollPercent(settings.duplicatePercent) ? 2 : 1;
+    stats.duplicatedPackets += copies - 1;
+    for (int i = 0; i < copies; i++) {
+        double delay = (double)settings.latencyMs * .001;
+        delay += (double)settings.jitterMs * .001 * (double)(RollZeroToOne() * 2.f - 1.f);
+        if (RollPercent(settings.reorderPercent)) {
+            delay += NET_SIM_REORDER_HOLD_SECONDS;
+            stats.reorderedPackets++;
+        }
+        Hold(direction, transport, packet, departTime + (delay > 0.0 ? delay : 0.0), now);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetSimulator::PopDuePacket(eNetSimDirection direction, double now, SimulatedPacket& packet)
+{
+    std::vector<SimulatedPacket>& held = m_held[direction];
+    if (held.empty() || held.front().releaseTime > now) {
+        return false;
+    }
+
+    std::pop_heap(held.begin(), held.end(), IsReleasedAfter);
+    packet = std::move(held.back());
+    held.pop_back();
+
+    NetSimStats& stats = m_stats[direction];
+    stats.releasedPackets++;
+    stats.totalDelaySeconds += now - packet.submitTime;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// call before a transport is deleted, its held packets have nowhere to go
+void NetSimulator::ForgetTransport(NetTransport* transport)
+{
+    for (int i = 0; i < NUM_NET_SIM_DIRECTIONS; i++) {
+        std::vector<SimulatedPacket>& held = m_held[i];
+        auto newEnd = std::remove_if(held.begin(), held.end(), [transport](SimulatedPacket const& packet) {
+            return packet.transport == transport;
+        });
+        if (newEnd != held.end()) {
+            held.erase(newEnd, held.end());
+            std::make_heap(held.begin(), held.end(), IsReleasedAfter);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetSimulator::IsEnabled(eNetSimDirection direction) const
+{
+    NetSimSettings const& settings = m_settings[direction];
+    return settings.latencyMs > 0.f || settings.jitterMs > 0.f || settings.lossPercent > 0.f ||
+        settings.duplicatePercent > 0.f || settings.reorderPercent > 0.f || settings.bandwidthKbps > 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// own scaling so results do not depend on the standard library's distributions
+float NetSimulator::RollZeroToOne()
+{
+    return (float)(m_rng() >> 8) / 16777216.f;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetSimulator::RollPercent(float percent)
+{
+    if (percent <= 0.f) {
+        return false;
+    }
+    return RollZeroToOne() * 100.f < percent;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetSimulator::Hold(eNetSimDirection direction, NetTransport* transport, std::string const& packet, double releaseTime, double now)
+{
+    std::vector<SimulatedPacket>& held = m_held[direction];
+    held.emplace_back();
+    SimulatedPacket& simPacket = held.back();
+    simPacket.transport = transport;
+    simPacket.data = packet;
+    simPacket.releaseTime = releaseTime;
+    simPacket.submitTime = now;
+    simPacket.order = m_nextOrder++;
+    std::push_heap(held.begin(), held.end(), IsReleasedAfter);
+}
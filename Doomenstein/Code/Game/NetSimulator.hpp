@@ -0,0 +1,91 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+class NetTransport;
+
+constexpr unsigned int NET_SIM_DEFAULT_SEED = 1;
+constexpr double NET_SIM_REORDER_HOLD_SECONDS = .03;   //extra hold for packets picked to reorder
+constexpr double NET_SIM_MAX_QUEUE_SECONDS = 1.0;      //bandwidth queue deeper than this tail drops
+
+//////////////////////////////////////////////////////////////////////////
+enum eNetSimDirection : int
+{
+    NET_SIM_OUTGOING = 0,
+    NET_SIM_INCOMING,
+
+    NUM_NET_SIM_DIRECTIONS
+};
+
+//////////////////////////////////////////////////////////////////////////
+// all zero means the direction passes packets straight through
+struct NetSimSettings
+{
+    float latencyMs = 0.f;
+    float jitterMs = 0.f;           //delay +- uniform, may reorder by itself
+    float lossPercent = 0.f;
+    float duplicatePercent = 0.f;
+    float reorderPercent = 0.f;
+    int bandwidthKbps = 0;          //0 is unlimited
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct NetSimStats
+{
+    long long submittedPackets = 0;
+    long long releasedPackets = 0;
+    long long lostPackets = 0;
+    long long overflowPackets = 0;  //dropped by bandwidth queue
+    long long duplicatedPackets = 0;
+    long long reorderedPackets = 0;
+    double totalDelaySeconds = 0.0; //over released packets
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct SimulatedPacket
+{
+    NetTransport* transport = nullptr;
+    std::string data;
+    double releaseTime = 0.0;
+    double submitTime = 0.0;
+    long long order = 0;    //ties release in submit order
+};
+
+// impairs packets per direction with a seeded rng so runs repeat,
+// main thread only: packets are held here and released once due
+class NetSimulator
+{
+public:
+    NetSimulator();
+
+    void SetSeed(unsigned int seed);
+    void SetSettings(eNetSimDirection direction, NetSimSettings const& settings);
+    void ResetStats();
+
+    void Submit(eNetSimDirection direction, NetTransport* transport, std::string const& packet, double now);
+    bool PopDuePacket(eNetSimDirection direction, double now, SimulatedPacket& packet);
+    void ForgetTransport(NetTransport* transport);
+
+    bool IsEnabled(eNetSimDirection direction) const;
+    unsigned int GetSeed() const {return m_seed;}
+    int GetHeldPacketCount(eNetSimDirection direction) const {return (int)m_held[direction].size();}
+    NetSimSettings const& GetSettings(eNetSimDirection direction) const {return m_settings[direction];}
+    NetSimStats const& GetStats(eNetSimDirection direction) const {return m_stats[direction];}
+
+private:
+    float RollZeroToOne();
+    bool RollPercent(float percent);
+    void Hold(eNetSimDirection direction, NetTransport* transport, std::string const& packet, double releaseTime, double now);
+
+private:
+    unsigned int m_seed = NET_SIM_DEFAULT_SEED;
+    std::mt19937 m_rng;
+    long long m_nextOrder = 0;
+
+    NetSimSettings m_settings[NUM_NET_SIM_DIRECTIONS];
+    NetSimStats m_stats[NUM_NET_SIM_DIRECTIONS];
+    double m_linkFreeTime[NUM_NET_SIM_DIRECTIONS] = {};    //when bandwidth capped link finishes current backlog
+    std::vector<SimulatedPacket> m_held[NUM_NET_SIM_DIRECTIONS];   //min heap on release time
+};
\ No newline at end of file
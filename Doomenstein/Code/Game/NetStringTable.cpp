@@ -0,0 +1,139 @@
+#include "Game/NetStringTable.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/Game.hpp"
+#include "Game/EntityDefinition.hpp"
+#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+//////////////////////////////////////////////////////////////////////////
+void NetStringTable::Build(std::vector<std::string> const& names)
+{
+    m_names = names;
+    std::sort(m_names.begin(), m_names.end());
+    m_names.erase(std::unique(m_names.begin(), m_names.end()), m_names.end());
+
+    //fnv-1a over names and separators
+    m_ids.clear();
+    m_hash = 2166136261u;
+    for (int i = 0; i < (int)m_names.size(); i++) {
+        m_ids[m_names[i]] = i;
+        for (char c : m_names[i]) {
+            m_hash = (m_hash ^ (unsigned char)c) * 16777619u;
+        }
+        m_hash = (m_hash ^ (unsigned char)'\n') * 16777619u;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+int NetStringTable::GetId(std::string_view name) const
+{
+    auto found = m_ids.find(name);
+    return found == m_ids.end() ? -1 : found->second;
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string const* NetStringTable::GetName(int id) const
+{
+    if (id < 0 || id >= (int)m_names.size()) {
+        return nullptr;
+    }
+    return &m_names[id];
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetStringTables::BuildLocal(Game const* game)
+{
+    std::vector<std::string> names;
+    for (EntityDef const* def : EntityDef::sEntityDefs) {
+        names.push_back(def->m_name);
+    }
+    m_tables[NET_STRINGS_ENTITY_DEF].Build(names);
+    m_tables[NET_STRINGS_MAP].Build(game->GetMapNames());
+    m_tables[NET_STRINGS_SOUND].Build(game->GetSoundPaths());
+    ResolveSoundIds();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetStringTables::SetTable(eNetStringTableType type, std::vector<std::string> const& names)
+{
+    m_tables[type].Build(names);
+    if (type == NET_STRINGS_SOUND) {
+        ResolveSoundIds();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string NetStringTables::Encode(eNetStringTableType type, std::string const& name) const
+{
+    int id = m_tables[type].GetId(name);
+    if (id < 0) {
+        return name;
+    }
+    return Stringf("#%i", id);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// token is either "#id" or the name itself
+bool NetStringTables::Decode(eNetStringTableType type, std::string_view token, std::string_view& name) const
+{
+    if (token.empty() || token[0] != '#') {
+        name = token;
+        return true;
+    }
+
+    int id = -1;
+    std::from_chars_result result = std::from_chars(token.data() + 1, token.data() + token.size(), id);
+    std::string const* found = m_isNegotiated && result.ec == std::errc() ? m_tables[type].GetName(id) : nullptr;
+    if (found == nullptr) {
+        return false;
+    }
+
+    name = *found;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string NetStringTables::EncodeSound(size_t soundId) const
+{
+    for (int i = 0; i < (int)m_soundIds.size(); i++) {
+        if (m_soundIds[i] == soundId) {
+            return Stringf("#%i", i);
+        }
+    }
+    return Stringf("%llu", (unsigned long long)soundId);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// raw local id kept as fallback for sounds outside the table
+bool NetStringTables::DecodeSound(std::string_view token, size_t& soundId) const
+{
+    bool isTableId = !token.empty() && token[0] == '#';
+    char const* begin = isTableId ? token.data() + 1 : token.data();
+    unsigned long long value = 0;
+    std::from_chars_result result = std::from_chars(begin, token.data() + token.size(), value);
+    if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+        return false;
+    }
+
+    if (!isTableId) {
+        soundId = (size_t)value;
+        return true;
+    }
+    if (!m_isNegotiated || value >= m_soundIds.size()) {
+        return false;
+    }
+    soundId = m_soundIds[(size_t)value];
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetStringTables::ResolveSoundIds()
+{
+    m_soundIds.clear();
+    for (std::string const& path : m_tables[NET_STRINGS_SOUND].GetNames()) {
+        m_soundIds.push_back(g_theAudio->CreateOrGetSound(path.c_str()));
+    }
+}
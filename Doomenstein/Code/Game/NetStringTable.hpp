@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Game;
+
+//////////////////////////////////////////////////////////////////////////
+enum eNetStringTableType
+{
+    NET_STRINGS_ENTITY_DEF,
+    NET_STRINGS_MAP,
+    NET_STRINGS_SOUND,
+
+    NUM_NET_STRING_TABLES
+};
+
+// sorted names with small integer ids, same names give same ids and hash everywhere
+class NetStringTable
+{
+public:
+    void Build(std::vector<std::string> const& names);
+
+    int GetId(std::string_view name) const;
+    std::string const* GetName(int id) const;
+    unsigned int GetHash() const {return m_hash;}
+    std::vector<std::string> const& GetNames() const {return m_names;}
+
+private:
+    std::vector<std::string> m_names;
+    std::map<std::string, int, std::less<>> m_ids;
+    unsigned int m_hash = 0;
+};
+
+// def, map and sound names agreed on join, messages then carry "#id" instead of text
+// names missing from the table are still sent as text
+class NetStringTables
+{
+public:
+    void BuildLocal(Game const* game);
+    void SetTable(eNetStringTableType type, std::vector<std::string> const& names);
+    void SetNegotiated(bool isNegotiated) {m_isNegotiated = isNegotiated;}
+
+    bool IsNegotiated() const {return m_isNegotiated;}
+    NetStringTable const& GetTable(eNetStringTableType type) const {return m_tables[type];}
+
+    std::string Encode(eNetStringTableType type, std::string const& name) const;
+    bool Decode(eNetStringTableType type, std::string_view token, std::string_view& name) const;
+    std::string EncodeSound(size_t soundId) const;
+    bool DecodeSound(std::string_view token, size_t& soundId) const;
+
+private:
+    void ResolveSoundIds();
+
+private:
+    NetStringTable m_tables[NUM_NET_STRING_TABLES];
+    std::vector<size_t> m_soundIds;     //local audio ids of sound table names
+    bool m_isNegotiated = false;
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Game/NetTransport.hpp"
+#include "Engine/Network/Network.hpp"
+#include "Engine/Network/UDPSocket.hpp"
+
+#include <unordered_map>
+
+static std::unordered_map<UDPSocket*, UDPTransport*> sTransportOfSocket;
+
+//////////////////////////////////////////////////////////////////////////
+UDPTransport* UDPTransport::GetTransportOfSocket(UDPSocket* soc)
+{
+    auto found = sTransportOfSocket.find(soc);
+    return found != sTransportOfSocket.end() ? found->second : nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+UDPTransport::UDPTransport(UDPSocket* socket)
+    : m_socket(socket)
+{
+    if (m_socket) {
+        sTransportOfSocket[m_socket] = this;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+UDPTransport::~UDPTransport()
+{
+    Close();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool UDPTransport::Send(std::string const& packet)
+{
+    if (m_socket == nullptr) {
+        return false;
+    }
+
+    m_socket->SendUDPMessage(packet);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool UDPTransport::IsValid() const
+{
+    return m_socket && m_socket->IsValid();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// socket may already be stopped by network clearing all sockets
+void UDPTransport::Close()
+{
+    if (m_socket == nullptr) {
+        return;
+    }
+
+    if (m_socket->IsValid()) {
+        g_theNetwork->StopUDPSocket(m_socket->GetBindPort());
+    }
+    sTransportOfSocket.erase(m_socket);
+    m_socket = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackTransport::CreatePair(LoopbackTransport*& endA, LoopbackTransport*& endB)
+{
+    std::shared_ptr<LoopbackLink> link = std::make_shared<LoopbackLink>();
+    endA = new LoopbackTransport(link, 0);
+    endB = new LoopbackTransport(link, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+LoopbackTransport::LoopbackTransport(std::shared_ptr<LoopbackLink> const& link, int side)
+    : m_link(link)
+    , m_side(side)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+LoopbackTransport::~LoopbackTransport()
+{
+    Close();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool LoopbackTransport::Send(std::string const& packet)
+{
+    std::lock_guard<std::mutex> lock(m_link->queueMutex);
+    if (!m_link->isOpen) {
+        return false;
+    }
+
+    m_link->queues[1 - m_side].push_back(packet);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// packets already in flight are still delivered after the link closes
+bool LoopbackTransport::Receive(std::string& packet)
+{
+    std::lock_guard<std::mutex> lock(m_link->queueMutex);
+    std::deque<std::string>& queue = m_link->queues[m_side];
+    if (queue.empty()) {
+        return false;
+    }
+
+    packet.swap(queue.front());
+    queue.pop_front();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool LoopbackTransport::IsValid() const
+{
+    std::lock_guard<std::mutex> lock(m_link->queueMutex);
+    return m_link->isOpen;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void LoopbackTransport::Close()
+{
+    std::lock_guard<std::mutex> lock(m_link->queueMutex);
+    m_link->isOpen = false;
+}
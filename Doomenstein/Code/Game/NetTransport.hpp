@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class UDPSocket;
+
+//////////////////////////////////////////////////////////////////////////
+// what a connection sends packets through, a udp socket or an in process link
+// Send may be called from the network io thread, the rest from main thread only
+class NetTransport
+{
+public:
+    virtual ~NetTransport() = default;
+
+    virtual bool Send(std::string const& packet) = 0;
+    virtual bool Receive(std::string& packet) = 0;  //polled transports only, udp arrives by event
+    virtual bool IsValid() const = 0;
+    virtual void Close() = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// engine udp socket, received packets come through UDPSocketReceive
+class UDPTransport : public NetTransport
+{
+public:
+    static UDPTransport* GetTransportOfSocket(UDPSocket* soc);
+
+    explicit UDPTransport(UDPSocket* socket);
+    ~UDPTransport();
+
+    bool Send(std::string const& packet) override;
+    bool Receive(std::string& packet) override {UNUSED(packet); return false;}
+    bool IsValid() const override;
+    void Close() override;
+
+    UDPSocket* GetSocket() const {return m_socket;}
+
+private:
+    UDPSocket* m_socket = nullptr;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// both directions of an in memory link, closing either end closes it
+struct LoopbackLink
+{
+    std::mutex queueMutex;
+    std::deque<std::string> queues[2];  //packets waiting for end 0 and end 1
+    bool isOpen = true;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// one end of a loopback link, sends land in the other end's queue
+class LoopbackTransport : public NetTransport
+{
+public:
+    static void CreatePair(LoopbackTransport*& endA, LoopbackTransport*& endB);
+
+    ~LoopbackTransport();
+
+    bool Send(std::string const& packet) override;
+    bool Receive(std::string& packet) override;
+    bool IsValid() const override;
+    void Close() override;
+
+private:
+    LoopbackTransport(std::shared_ptr<LoopbackLink> const& link, int side);
+
+private:
+    std::shared_ptr<LoopbackLink> m_link;
+    int m_side = 0;
+};
\ No newline at end of file
@@ -8,18 +8,41 @@
 #include "Game/Server.hpp"
 #include "Game/RemoteServer.hpp"
 #include "Game/AuthoritativeServer.hpp"
+#include "Game/NetBufferReader.hpp"
+#include "Game/NetStringTable.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Network/NetworkCommon.hpp"
 
+#include <random>
 #include <set>
 
-static unsigned short sSequenceNo = 0;
 static std::set<int> sUsedPorts;
+static char const* sMessageTypeNames[NUM_NET_MESSAGE_TYPES] = {"invalid", "add_player", "player_input", "entity_transform",
+    "entity_create", "entity_delete", "entity_teleport", "actor_health", "sound_play", "player_state",
+    "clock_sync_request", "clock_sync_response", "fragment", "entity_baseline", "string_table", "string_table_ack"};
+
+//fields present in a delta coded input
+enum eInputField : int
+{
+    INPUT_FIELD_DELTA_SECONDS   = 1 << 0,
+    INPUT_FIELD_MOVE_X          = 1 << 1,
+    INPUT_FIELD_MOVE_Y          = 1 << 2,
+    INPUT_FIELD_MOUSE_X         = 1 << 3,
+    INPUT_FIELD_MOUSE_Y         = 1 << 4,
+    INPUT_FIELD_FLAGS           = 1 << 5
+};
+
+//////////////////////////////////////////////////////////////////////////
+static int GetInputFlags(InputInfo const& input)
+{
+    return (input.isClosing ? 1 : 0) | (input.isFiring ? 2 : 0);
+}
 
 //////////////////////////////////////////////////////////////////////////
 int RollRandomUnusedPort()
@@ -33,50 +56,39 @@ int RollRandomUnusedPort()
 }
 
 //////////////////////////////////////////////////////////////////////////
-eNetMessageHeaderType GetHeaderTypeForMessage(std::string const& msg)
+void ReleaseUsedPort(int port)
 {
-    NetMessageHeader const* head = reinterpret_cast<NetMessageHeader const*>(&msg[0]);
-    eNetMessageHeaderType type = (eNetMessageHeaderType)head->m_type;
-    return type;
+    sUsedPorts.erase(port);
 }
 
 //////////////////////////////////////////////////////////////////////////
-unsigned short GetSeqNoForMessage(std::string const& msg)
+eNetMessageHeaderType GetHeaderTypeForMessage(std::string const& msg)
 {
     NetMessageHeader const* head = reinterpret_cast<NetMessageHeader const*>(&msg[0]);
-    return head->m_seqNo;
+    eNetMessageHeaderType type = (eNetMessageHeaderType)head->m_type;
+    return type;
 }
 
 //////////////////////////////////////////////////////////////////////////
-int GetEntityIdxFromOneTrunkMessage(std::string const& msg)
+char const* GetNameForMessageType(eNetMessageHeaderType type)
 {
-    std::string content(&msg[MESSAGE_HEADER_LEN]);
-    return StringConvert(content.c_str(),-1);
+    if (type >= NUM_NET_MESSAGE_TYPES) {
+        return "unknown";
+    }
+    return sMessageTypeNames[type];
 }
 
 //////////////////////////////////////////////////////////////////////////
-int GetEntityIdxFromTwoChunksMessage(std::string const& msg)
+unsigned short GetSeqNoForMessage(std::string const& msg)
 {
-    std::string content(&msg[MESSAGE_HEADER_LEN]);
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 2) {
-        return -1;
-    }
-
-    return StringConvert(trunks[0].c_str(), -1);
+    NetMessageHeader const* head = reinterpret_cast<NetMessageHeader const*>(&msg[0]);
+    return head->m_seqNo;
 }
 
 //////////////////////////////////////////////////////////////////////////
-void GetEntityCreateInfoFromMessage(std::string const& msg, int& idx, std::string& type)
+SharedMessage MakeSharedMessage(std::string&& msg)
 {
-    std::string content(&msg[MESSAGE_HEADER_LEN]);
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 4) {
-        return;
-    }
-
-    idx = StringConvert(trunks[0].c_str(), -1);
-    type = trunks[1];
+    return std::make_shared<std::string const>(std::move(msg));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -86,39 +98,82 @@ std::string MakeMessageHeader(eNetMessageHeaderType type)
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = type;
     headerPtr->m_size = 0;
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
     return std::string(header, MESSAGE_HEADER_LEN);
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeCustomClientConnectPackage(std::string const& clientIP)
+// from the os source, not the seeded game rng whose sequence anyone can replay
+unsigned int RollSecretNumber()
+{
+    static std::random_device sSource;
+    return (unsigned int)sSource();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// identifier is the packet key the server demultiplexes on, so it must be unique
+// and unguessable, the shared listen socket has nothing else to tell senders apart
+// 0 and -1 mean no key yet
+int RollUnusedIdentifier()
+{
+    int identifier = (int)RollSecretNumber();
+    while (identifier == 0 || identifier == -1 || g_theServer->GetClientOfIdentifier(identifier) != nullptr) {
+        identifier = (int)RollSecretNumber();
+    }
+    return identifier;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// client steps go out under the client start header, server steps under the connect one
+std::string MakeHandshakePackage(HandshakeInfo const& info)
 {
-    std::string packHeader= MakeClientConnectPackageHeader();
+    std::string content = Stringf("%i;%u", (int)info.step, info.nonce);
+    switch (info.step) {
+    case HANDSHAKE_REQUEST:     content += Stringf(";%.*s;%i", (int)info.replyIP.size(), info.replyIP.data(), info.replyPort); break;
+    case HANDSHAKE_CHALLENGE:   content += Stringf(";%u", info.token); break;
+    case HANDSHAKE_RESPONSE:    content += Stringf(";%u|%.*s", info.token, (int)info.addPlayer.size(), info.addPlayer.data()); break;
+    case HANDSHAKE_ACCEPT:      content += Stringf(";%i;%i", info.identifier, info.pawnIndex); break;
+    }
+
+    bool isFromClient = info.step == HANDSHAKE_REQUEST || info.step == HANDSHAKE_RESPONSE;
+    std::string packHeader = isFromClient ? MakeClientStartPackageHeader() : MakeClientConnectPackageHeader();
     NetworkPackageHeader* pHeaderPtr = reinterpret_cast<NetworkPackageHeader*>(&packHeader[0]);
-    int bindPort =RollRandomUnusedPort();
-    int toPort = RollRandomUnusedPort();
-    int identifier = g_theRNG->RollRandomIntInRange(INT_MIN+1, INT_MAX-1);
-    while (identifier >= 0 && identifier < 100000) {
-        identifier = g_theRNG->RollRandomIntInRange(INT_MIN + 1, INT_MAX - 1);
-    }
-    //TODO not handled same identifier
-    g_theServer->CreateUDPSocket(clientIP,bindPort, toPort, identifier);
-    std::string content = Stringf("%i;%i;%i", toPort,bindPort,identifier);
+    pHeaderPtr->m_key = 0;
     pHeaderPtr->m_size = (uint16_t)content.size();
-    return packHeader+content;
+    return packHeader + content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakePlayerInputMessage(InputInfo const& input)
+// consecutive inputs oldest first, each only writes fields changed from the one before
+std::string MakePlayerInputMessage(std::vector<InputInfo> const& inputs)
 {
-    std::string content = Stringf("%f,%f;%f,%f;%i;%i",input.playerMove.x,input.playerMove.y,
-        input.mouseMove.x,input.mouseMove.y,(int)input.isClosing, (int)input.isFiring);
-    
+    int firstSeq = inputs.empty() ? 0 : (int)inputs[0].seq;
+    std::string content = Stringf("%i;%i", firstSeq, (int)inputs.size());
+    InputInfo prev;
+    for (InputInfo const& input : inputs) {
+        int mask = 0;
+        mask |= input.deltaSeconds != prev.deltaSeconds ? INPUT_FIELD_DELTA_SECONDS : 0;
+        mask |= input.playerMove.x != prev.playerMove.x ? INPUT_FIELD_MOVE_X : 0;
+        mask |= input.playerMove.y != prev.playerMove.y ? INPUT_FIELD_MOVE_Y : 0;
+        mask |= input.mouseMove.x != prev.mouseMove.x ? INPUT_FIELD_MOUSE_X : 0;
+        mask |= input.mouseMove.y != prev.mouseMove.y ? INPUT_FIELD_MOUSE_Y : 0;
+        mask |= GetInputFlags(input) != GetInputFlags(prev) ? INPUT_FIELD_FLAGS : 0;
+
+        content += Stringf(";%i", mask);
+        if (mask & INPUT_FIELD_DELTA_SECONDS) { content += Stringf(";%g", input.deltaSeconds); }
+        if (mask & INPUT_FIELD_MOVE_X)        { content += Stringf(";%g", input.playerMove.x); }
+        if (mask & INPUT_FIELD_MOVE_Y)        { content += Stringf(";%g", input.playerMove.y); }
+        if (mask & INPUT_FIELD_MOUSE_X)       { content += Stringf(";%g", input.mouseMove.x); }
+        if (mask & INPUT_FIELD_MOUSE_Y)       { content += Stringf(";%g", input.mouseMove.y); }
+        if (mask & INPUT_FIELD_FLAGS)         { content += Stringf(";%i", GetInputFlags(input)); }
+        prev = input;
+    }
+
     char header[MESSAGE_HEADER_LEN];
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_PLAYER_INPUT;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     std::string package = std::string(header,MESSAGE_HEADER_LEN);
     return package+content;
@@ -140,16 +195,33 @@ std::string MakeEntityTransformMessage(Entity const* entity)
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ENTITY_TRANSFORM;
     headerPtr->m_size=(unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     std::string msgHeader = std::string(header, MESSAGE_HEADER_LEN);
     return msgHeader+content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeEntityCreateMessage(Entity const* entity)
+static std::string EncodeTableName(NetStringTables const* tables, eNetStringTableType type, std::string const& name)
+{
+    return tables ? tables->Encode(type, name) : name;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static bool DecodeTableName(eNetStringTableType type, std::string_view token, std::string_view& name)
+{
+    if (!g_theServer->m_stringTables.Decode(type, token, name)) {
+        g_theConsole->PrintError(Stringf("Unknown string table id %.*s", (int)token.size(), token.data()));
+        return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string MakeEntityCreateMessage(Entity const* entity, NetStringTables const* tables)
 {
-    std::string type = entity->GetEntityDefinition()->m_name;
+    std::string type = EncodeTableName(tables, NET_STRINGS_ENTITY_DEF, entity->GetEntityDefinition()->m_name);
+    std::string mapName = EncodeTableName(tables, NET_STRINGS_MAP, entity->GetMap()->GetName());
     Vec2 pos = entity->GetEntityPosition2D();
     Vec3 pitchYawRoll = entity->GetEntityPitchYawRollDegrees();
     float damage = 0.f;
@@ -157,34 +229,40 @@ std::string MakeEntityCreateMessage(Entity const* entity)
         damage = ((Projectile*)entity)->GetDamage();
     }
     std::string content = Stringf("%i;%s;%s;%f",entity->GetIndex(), type.c_str(),
-        entity->GetMap()->GetName().c_str(), damage);
+        mapName.c_str(), damage);
+    if (entity->GetEntityType() == ENTITY_PROJECTILE) {
+        //only replicated state of a projectile, clients fly it themselves
+        float height = ((Projectile*)entity)->GetFlyHeight();
+        content += Stringf(";%f,%f,%f;%f;%f;%f", pos.x, pos.y, height, pitchYawRoll.x, pitchYawRoll.y, 
+            GetCurrentTimeSeconds());
+    }
 
     char header[MESSAGE_HEADER_LEN];
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ENTITY_CREATE;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     std::string msgHeader = std::string(header, MESSAGE_HEADER_LEN);
     return msgHeader+content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeEntityTeleportMessage(Entity const* entity)
+std::string MakeEntityTeleportMessage(Entity const* entity, NetStringTables const* tables)
 {
-    return MakeEntityTeleportMessage(entity->GetIndex(), entity->GetMap()->GetName().c_str());
+    return MakeEntityTeleportMessage(entity->GetIndex(), entity->GetMap()->GetName(), tables);
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeEntityTeleportMessage(int entityIdx, std::string const& mapName)
+std::string MakeEntityTeleportMessage(int entityIdx, std::string const& mapName, NetStringTables const* tables)
 {
-    std::string content = Stringf("%i;%s", entityIdx, mapName.c_str());
+    std::string content = Stringf("%i;%s", entityIdx, EncodeTableName(tables, NET_STRINGS_MAP, mapName).c_str());
 
     char header[MESSAGE_HEADER_LEN];
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ENTITY_TELEPORT;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
@@ -198,21 +276,21 @@ std::string MakeEntityDeleteMessage(int entityIdx)
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ENTITY_DELETE;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeSoundPlayMessage(size_t id)
+std::string MakeSoundPlayMessage(size_t id, NetStringTables const* tables)
 {
-    std::string content = Stringf("%llu", id);
+    std::string content = tables ? tables->EncodeSound(id) : Stringf("%llu", id);
 
     char header[MESSAGE_HEADER_LEN];
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_SOUND_PLAY;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
@@ -226,41 +304,146 @@ std::string MakeActorHealthMessage(int entityIdx, float newHealth)
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
     headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ACTOR_HEALTH;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeReliableACKMessage(unsigned short msgSeqNo)
+std::string MakePlayerStateMessage(Entity const* pawn, unsigned short lastInputSeq)
 {
-    std::string content = Stringf("%u", msgSeqNo);
+    Vec2 pos = pawn->GetEntityPosition2D();
+    Vec3 pitchYawRoll = pawn->GetEntityPitchYawRollDegrees();
+    std::string content = Stringf("%i;%f,%f;%f;%f", (int)lastInputSeq, pos.x, pos.y, pitchYawRoll.x, pitchYawRoll.y);
 
     char header[MESSAGE_HEADER_LEN];
     NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
-    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ACK;
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_PLAYER_STATE;
     headerPtr->m_size = (unsigned short)content.size();
-    headerPtr->m_seqNo = sSequenceNo++;
+    headerPtr->m_seqNo = 0;
 
     return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-std::string MakeClientStartMessage(int udpToPort, int udpBindPort)
+std::string MakeClockSyncRequestMessage(double clientSendTime)
 {
-    std::string packHeader = MakeClientStartPackageHeader();
-    NetworkPackageHeader* pHeaderPtr = reinterpret_cast<NetworkPackageHeader*>(&packHeader[0]);
-    std::string content = Stringf("%i;%i", udpBindPort, udpToPort);
-    pHeaderPtr->m_size = (uint16_t)content.size();
-    return packHeader + content;
+    std::string content = Stringf("%.6f", clientSendTime);
+
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_CLOCK_SYNC_REQUEST;
+    headerPtr->m_size = (unsigned short)content.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + content;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseActorHealthMessage(std::string const& content)
+std::string MakeClockSyncResponseMessage(double clientSendTime, double serverReceiveTime, double serverSendTime)
 {
-    Strings trunks = SplitStringOnDelimiter(content, ';');
+    std::string content = Stringf("%.6f;%.6f;%.6f", clientSendTime, serverReceiveTime, serverSendTime);
+
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_CLOCK_SYNC_RESPONSE;
+    headerPtr->m_size = (unsigned short)content.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + content;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one entity of a join baseline, records of a chunk joined by '|'
+std::string MakeEntityBaselineRecord(Entity const* entity, NetStringTables const* tables)
+{
+    Vec2 pos = entity->GetEntityPosition2D();
+    float health = -1.f;
+    if (entity->GetEntityType() == ENTITY_ACTOR) {
+        health = ((Actor const*)entity)->GetHealth();
+    }
+
+    std::string type = EncodeTableName(tables, NET_STRINGS_ENTITY_DEF, entity->GetEntityDefinition()->m_name);
+    std::string mapName = EncodeTableName(tables, NET_STRINGS_MAP, entity->GetMap()->GetName());
+    return Stringf("%i;%s;%s;%.3f,%.3f;%.1f;%.1f", entity->GetIndex(), type.c_str(), mapName.c_str(), 
+        pos.x, pos.y, entity->GetEntityPitchYawRollDegrees().y, health);
+}
+
+//////////////////////////////////////////////////////////////////////////
+std::string MakeEntityBaselineMessage(std::string const& records)
+{
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ENTITY_BASELINE;
+    headerPtr->m_size = (unsigned short)records.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + records;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// joiner sends hashes of its own tables, server only resends tables that differ
+std::string MakeAddPlayerMessage(NetStringTables const& localTables)
+{
+    std::string content;
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        content += Stringf(i == 0 ? "%u" : ";%u", localTables.GetTable((eNetStringTableType)i).GetHash());
+    }
+
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_ADD_PLAYER;
+    headerPtr->m_size = (unsigned short)content.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + content;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// per table "hash;names" joined by '|', names "=" when remote already has them
+std::string MakeStringTableMessage(NetStringTables const& tables, std::vector<unsigned int> const& remoteHashes)
+{
+    std::string content;
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        NetStringTable const& table = tables.GetTable((eNetStringTableType)i);
+        if (i > 0) {
+            content += '|';
+        }
+        content += Stringf("%u;", table.GetHash());
+
+        if (i < (int)remoteHashes.size() && remoteHashes[i] == table.GetHash()) {
+            content += '=';
+            continue;
+        }
+        std::vector<std::string> const& names = table.GetNames();
+        for (size_t n = 0; n < names.size(); n++) {
+            if (n > 0) {
+                content += ',';
+            }
+            content += names[n];
+        }
+    }
+
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_STRING_TABLE;
+    headerPtr->m_size = (unsigned short)content.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + content;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool ParseActorHealthMessage(std::string_view content)
+{
+    NetMessageReader reader(content);
+    int idx = -1;
+    float newHealth = 0.f;
+    if (!reader.ReadInt(idx) || !reader.ReadFloat(newHealth)) {
+        g_theConsole->PrintError(Stringf("Fail to parse actor health %.*s", (int)content.size(), content.data()));
+        return false;
+    }
 
-    int idx = StringConvert(trunks[0].c_str(), -1);
     Entity* entity = nullptr;
     entity = g_theGame->GetEntityOfIndex(idx);
     if (entity == nullptr || entity->GetEntityType() != ENTITY_ACTOR) {
@@ -268,15 +451,17 @@ bool ParseActorHealthMessage(std::string const& content)
         return false;
     }
 
-    float newHealth = StringConvert(trunks[1].c_str(), 0.f);
     ((Actor*)entity)->SetHealth(newHealth);
     return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseEntityDeleteMessage(std::string const& content)
+// idx set even when entity is unknown, its create or baseline may still be on the way
+bool ParseEntityDeleteMessage(std::string_view content, int& idx)
 {
-    int idx = StringConvert(content.c_str(), -1);
+    NetMessageReader reader(content);
+    idx = -1;
+    reader.ReadInt(idx);
     Entity* entity = nullptr;
     entity = g_theGame->GetEntityOfIndex(idx);
     if (entity == nullptr) {
@@ -289,15 +474,19 @@ bool ParseEntityDeleteMessage(std::string const& content)
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseEntityTeleportMessage(std::string const& content)
+bool ParseEntityTeleportMessage(std::string_view content)
 {
-    Strings trunks = SplitStringOnDelimiter(content, ';');
-    if (trunks.size() != 2) {
-        g_theConsole->PrintError(Stringf("Fail to parse entity teleport %s", content.c_str()));
+    NetMessageReader reader(content);
+    int idx = -1;
+    std::string_view mapName;
+    if (!reader.ReadInt(idx) || !reader.ReadToken(mapName) || !reader.IsAtEnd()) {
+        g_theConsole->PrintError(Stringf("Fail to parse entity teleport %.*s", (int)content.size(), content.data()));
+        return false;
+    }
+    if (!DecodeTableName(NET_STRINGS_MAP, mapName, mapName)) {
         return false;
     }
 
-    int idx = StringConvert(trunks[0].c_str(),-1);
     Entity* entity = nullptr;
     entity = g_theGame->GetEntityOfIndex(idx);
     if (entity == nullptr) {
@@ -311,178 +500,397 @@ bool ParseEntityTeleportMessage(std::string const& content)
             g_theConsole->PrintError(Stringf("Fail to find client of pawn idx %i", idx));
             return false;
         }
-        g_theServer->SwitchPlayerMap(c, trunks[1]);
+        g_theServer->SwitchPlayerMap(c, std::string(mapName));
     }
     else {
         RemoteServer* remoServer = static_cast<RemoteServer*>(g_theServer);
-        remoServer->ActualSwitchPlayerMap(entity, trunks[1]);
+        remoServer->ActualSwitchPlayerMap(entity, std::string(mapName));
     }
     
     return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseClientConnectPackage(std::string const& content)
+// return nullptr if entity of same type already exists
+static Entity* SpawnEntityForCreate(int idx, std::string_view typeName, std::string_view mapName)
 {
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 3) {
-        g_theConsole->PrintError(Stringf("Fail to parse client connect %s", content.c_str()));
-        return false;
+    Entity* entity = g_theGame->GetEntityOfIndex(idx);
+    if(entity){
+        std::string const& entityTypeName = entity->GetEntityDefinition()->m_name;
+        if (entityTypeName != typeName) {
+            g_theConsole->PrintError(Stringf("Deleting existing entity of type %s not same as create type %.*s",
+                entityTypeName.c_str(), (int)typeName.size(), typeName.data()));
+            g_theGame->RemoveEntity(entity);
+            entity = nullptr;
+        }
+        else {
+            return nullptr;
+        }
     }
 
-    if(g_theServer->m_isAuthoritative){
-        g_theConsole->PrintError("Fail to receive client connect package on server");
-        return false;
+    entity = g_theGame->SpawnEntityAtPlayerStart(0, std::string(typeName));
+    entity->SetIndex(idx);
+
+    //switch map
+    g_theGame->SwitchMapForEntity(std::string(mapName), entity);
+    return entity;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// deleted indices had their delete overtake this create, nothing is spawned for them
+Entity* ParseEntityCreateMessage(std::string_view content, std::unordered_set<int> const& deletedIndices)
+{
+    NetMessageReader reader(content);
+    int idx = -1;
+    std::string_view typeName;
+    std::string_view mapName;
+    std::string_view rawDamage;
+    if (!reader.ReadInt(idx) || !reader.ReadToken(typeName) || !reader.ReadToken(mapName) || 
+        !reader.ReadToken(rawDamage)) {
+        g_theConsole->PrintError(Stringf("Fail to parse entity create %.*s", (int)content.size(), content.data()));
+        return nullptr;
+    }
+    if (!DecodeTableName(NET_STRINGS_ENTITY_DEF, typeName, typeName) || !DecodeTableName(NET_STRINGS_MAP, mapName, mapName)) {
+        return nullptr;
+    }
+    if (deletedIndices.find(idx) != deletedIndices.end()) {
+        return nullptr;
     }
 
-    int toPort = StringConvert(trunks[0].c_str(),48000);
-    int bindPort = StringConvert(trunks[1].c_str(),48000);
-    int identifier = StringConvert(trunks[2].c_str(),0xffffffff);
-    RemoteServer* remoServer = static_cast<RemoteServer*>(g_theServer);
-    g_theServer->CreateUDPSocket(remoServer->m_serverIP, toPort,bindPort,identifier);
-    return true;
+    Entity* entity = SpawnEntityForCreate(idx, typeName, mapName);
+    if (entity == nullptr) {
+        return nullptr;
+    }
+
+    if (entity->GetEntityType() == ENTITY_PROJECTILE) {
+        NetMessageReader damageReader(rawDamage);
+        float damage = 0.f;
+        damageReader.ReadFloat(damage);
+        ((Projectile*)entity)->SetDamage(damage);
+
+        Vec2 pos;
+        float height = 0.f;
+        Vec3 pitchYawRoll = entity->GetEntityPitchYawRollDegrees();
+        double stateTime = 0.0;
+        if (!reader.ReadFloat(pos.x, ',') || !reader.ReadFloat(pos.y, ',') || !reader.ReadFloat(height) ||
+            !reader.ReadFloat(pitchYawRoll.x) || !reader.ReadFloat(pitchYawRoll.y) || !reader.ReadDouble(stateTime)) {
+            g_theConsole->PrintError(Stringf("Fail to parse projectile spawn %.*s", (int)content.size(), content.data()));
+        }
+        else {
+            entity->SetPosition(pos);
+            entity->SetPitchYawRollDegrees(pitchYawRoll);
+            ((Projectile*)entity)->SetHeight(height);
+
+            //catch up on flight time spent in transit
+            if (g_theServer->IsServerTimeSynced()) {
+                float age = (float)(g_theServer->GetServerTime() - stateTime);
+                ((Projectile*)entity)->Advance(Clamp(age, 0.f, MAX_PROJECTILE_CATCH_UP_SECONDS));
+            }
+        }
+    }
+
+    return entity;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseClientStartMessage(std::string const& content, TCPSocket* client)
+bool DecodeEntityTransformMessage(std::string_view content, EntityTransformInfo& info)
 {
-    Strings trunks = SplitStringOnDelimiter(content, ';');
-    if (trunks.size() != 2) {
-        g_theConsole->PrintError(Stringf("Fail to parse client start %s", content.c_str()));
+    NetMessageReader reader(content);
+    return reader.ReadInt(info.idx) &&
+        reader.ReadFloat(info.x, ',') && reader.ReadFloat(info.y, ',') && reader.ReadFloat(info.height) &&
+        reader.ReadFloat(info.pitch) && reader.ReadFloat(info.yaw) && reader.IsAtEnd();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool ParseEntityTransformMessage(std::string_view content)
+{
+    EntityTransformInfo info;
+    if (!DecodeEntityTransformMessage(content, info)) {
+        g_theConsole->PrintError(Stringf("Fail to parse entity transform content %.*s", (int)content.size(), content.data()));
         return false;
     }
 
-    if (!g_theServer->m_isAuthoritative) {
-        g_theConsole->PrintError("Fail to receive client start package on remote server");
+    Entity* entity = g_theGame->GetEntityOfIndex(info.idx);
+    if (entity == nullptr) {
+        g_theConsole->PrintError(Stringf("Fail to get entity of idx %i",info.idx));
         return false;
     }
 
-    int toPort = StringConvert(trunks[0].c_str(), 0);
-    int bindPort = StringConvert(trunks[1].c_str(), 0);
-    AuthoritativeServer* server = (AuthoritativeServer*)g_theServer;
-    server->UpdateTCPUDPReference(client, toPort, bindPort);
+    entity->SetPosition(Vec2(info.x, info.y));
+    if (entity->GetEntityType() == ENTITY_PROJECTILE) {
+        ((Projectile*)entity)->SetHeight(info.height);
+    }
+
+    Vec3 pitchYawRoll = entity->GetEntityPitchYawRollDegrees();
+    pitchYawRoll.x = info.pitch;
+    pitchYawRoll.y = info.yaw;
+    entity->SetPitchYawRollDegrees(pitchYawRoll);
     return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-Entity* ParseEntityCreateMessage(std::string const& content)
+bool ParsePlayerInputMessage(std::string_view content, std::vector<InputInfo>& inputs)
 {
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 4) {
-        g_theConsole->PrintError(Stringf("Fail to parse entity create %s", content.c_str()));
-        return nullptr;
+    inputs.clear();
+
+    NetMessageReader reader(content);
+    int firstSeq = 0;
+    int count = 0;
+    if (!reader.ReadInt(firstSeq) || !reader.ReadInt(count) || count < 0 || count > MAX_INPUTS_PER_MESSAGE) {
+        g_theConsole->PrintError(Stringf("Fail to parse player input content %.*s", (int)content.size(), content.data()));
+        return false;
     }
 
-    int idx = StringConvert(trunks[0].c_str(),-1);
-    Entity* entity = nullptr;    
-    entity = g_theGame->GetEntityOfIndex(idx);
-    if(entity){
-        std::string entityTypeName = entity->GetEntityDefinition()->m_name;
-        if (entityTypeName != trunks[1]) {
-            g_theConsole->PrintError(Stringf("Deleting existing entity of type %s not same as create type %s",
-                entityTypeName.c_str(), trunks[1].c_str()));
-            g_theGame->RemoveEntity(entity);
-            entity = nullptr;
-        }
-        else {
-            return nullptr;
+    InputInfo prev;
+    for (int i = 0; i < count; i++) {
+        InputInfo input = prev;
+        int mask = 0;
+        int flags = GetInputFlags(prev);
+        bool isValid = reader.ReadInt(mask);
+        isValid = isValid && (!(mask & INPUT_FIELD_DELTA_SECONDS) || reader.ReadFloat(input.deltaSeconds));
+        isValid = isValid && (!(mask & INPUT_FIELD_MOVE_X) || reader.ReadFloat(input.playerMove.x));
+        isValid = isValid && (!(mask & INPUT_FIELD_MOVE_Y) || reader.ReadFloat(input.playerMove.y));
+        isValid = isValid && (!(mask & INPUT_FIELD_MOUSE_X) || reader.ReadFloat(input.mouseMove.x));
+        isValid = isValid && (!(mask & INPUT_FIELD_MOUSE_Y) || reader.ReadFloat(input.mouseMove.y));
+        isValid = isValid && (!(mask & INPUT_FIELD_FLAGS) || reader.ReadInt(flags));
+        if (!isValid) {
+            g_theConsole->PrintError(Stringf("Fail to parse player input %i of %.*s", i, (int)content.size(), content.data()));
+            inputs.clear();
+            return false;
         }
-    }
-    if (entity == nullptr) {
-        entity = g_theGame->SpawnEntityAtPlayerStart(0, trunks[1]);
-        entity->SetIndex(idx);
+
+        input.isClosing = (flags & 1) != 0;
+        input.isFiring = (flags & 2) != 0;
+        input.seq = (unsigned short)(firstSeq + i);
+        prev = input;
+
+        input.playerMove.x = Clamp(input.playerMove.x, -1.f, 1.f);
+        input.playerMove.y = Clamp(input.playerMove.y, -1.f, 1.f);
+        input.mouseMove.x = Clamp(input.mouseMove.x, -1.f, 1.f);
+        input.mouseMove.y = Clamp(input.mouseMove.y, -1.f, 1.f);
+        input.deltaSeconds = Clamp(input.deltaSeconds, 0.f, MAX_INPUT_DELTA_SECONDS);
+        inputs.push_back(input);
     }
 
-    //switch map
-    std::string mapName = trunks[2];
-    g_theGame->SwitchMapForEntity(mapName, entity);
+    return true;
+}
 
-    float damage = 0.f;
-    if (entity->GetEntityType() == ENTITY_PROJECTILE) {
-        damage = StringConvert(trunks[3].c_str(), 0.f);
-        ((Projectile*)entity)->SetDamage(damage);
+//////////////////////////////////////////////////////////////////////////
+bool ParseSoundPlayMessage(std::string_view content, size_t& id)
+{
+    if (!g_theServer->m_stringTables.DecodeSound(content, id)) {
+        g_theConsole->PrintError(Stringf("Fail to parse sound play %.*s", (int)content.size(), content.data()));
+        return false;
     }
-
-    return entity;
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParseEntityTransformMessage(std::string const& content)
+bool ParsePlayerStateMessage(std::string_view content, PlayerStateInfo& state)
 {
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 4) {
-        g_theConsole->PrintError(Stringf("Fail to parse entity transform content %s", content.c_str()));
+    NetMessageReader reader(content);
+    int seq = 0;
+    if (!reader.ReadInt(seq) || !reader.ReadFloat(state.x, ',') || !reader.ReadFloat(state.y) ||
+        !reader.ReadFloat(state.pitch) || !reader.ReadFloat(state.yaw) || !reader.IsAtEnd()) {
+        g_theConsole->PrintError(Stringf("Fail to parse player state %.*s", (int)content.size(), content.data()));
         return false;
     }
 
-    int idx = StringConvert(trunks[0].c_str(),-1);
-    Entity* entity = g_theGame->GetEntityOfIndex(idx);
-    if (entity == nullptr) {
-        g_theConsole->PrintError(Stringf("Fail to get entity of idx %i",idx));
+    state.lastInputSeq = (unsigned short)seq;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool ParseClockSyncRequestMessage(std::string_view content, double& clientSendTime)
+{
+    NetMessageReader reader(content);
+    if (!reader.ReadDouble(clientSendTime) || !reader.IsAtEnd()) {
+        g_theConsole->PrintError(Stringf("Fail to parse clock sync request %.*s", (int)content.size(), content.data()));
         return false;
     }
+    return true;
+}
 
-    Strings rawPos = SplitStringOnDelimiter(trunks[1],',');
-    if (rawPos.size() != 3) {
-        g_theConsole->PrintError(Stringf("Fail to parse entity pos %s", trunks[1].c_str()));
+//////////////////////////////////////////////////////////////////////////
+bool ParseClockSyncResponseMessage(std::string_view content, double& clientSendTime, double& serverReceiveTime, double& serverSendTime)
+{
+    NetMessageReader reader(content);
+    if (!reader.ReadDouble(clientSendTime) || !reader.ReadDouble(serverReceiveTime) || 
+        !reader.ReadDouble(serverSendTime) || !reader.IsAtEnd()) {
+        g_theConsole->PrintError(Stringf("Fail to parse clock sync response %.*s", (int)content.size(), content.data()));
+        return false;
     }
-    else
-    {
-        Vec2 newPos = entity->GetEntityPosition2D();
-        newPos.x = StringConvert(rawPos[0].c_str(),newPos.x);
-        newPos.y = StringConvert(rawPos[1].c_str(),newPos.y);
-        entity->SetPosition(newPos);
+    return true;
+}
 
-        float height = StringConvert(rawPos[2].c_str(), 0.f);
-        if (entity->GetEntityType() == ENTITY_PROJECTILE) {
-            ((Projectile*)entity)->SetHeight(height);
+//////////////////////////////////////////////////////////////////////////
+// records of deleted indices are skipped, baseline and deletes are unordered reliables
+bool ParseEntityBaselineMessage(std::string_view content, std::vector<Entity*>& spawnedEntities, std::unordered_set<int> const& deletedIndices)
+{
+    spawnedEntities.clear();
+    NetMessageReader records(content);
+    std::string_view record;
+    while (records.ReadToken(record, '|')) {
+        NetMessageReader reader(record);
+        int idx = -1;
+        std::string_view typeName;
+        std::string_view mapName;
+        Vec2 pos;
+        float yaw = 0.f;
+        float health = 0.f;
+        if (!reader.ReadInt(idx) || !reader.ReadToken(typeName) || !reader.ReadToken(mapName) ||
+            !reader.ReadFloat(pos.x, ',') || !reader.ReadFloat(pos.y) || !reader.ReadFloat(yaw) || 
+            !reader.ReadFloat(health) || !reader.IsAtEnd()) {
+            g_theConsole->PrintError(Stringf("Fail to parse entity baseline %.*s", (int)record.size(), record.data()));
+            return false;
+        }
+        if (!DecodeTableName(NET_STRINGS_ENTITY_DEF, typeName, typeName) || !DecodeTableName(NET_STRINGS_MAP, mapName, mapName) ||
+            deletedIndices.find(idx) != deletedIndices.end()) {
+            continue;
         }
-    }
 
-    Vec3 pitchYawRoll = entity->GetEntityPitchYawRollDegrees();
-    pitchYawRoll.x = StringConvert(trunks[2].c_str(),pitchYawRoll.x);
-    pitchYawRoll.y = StringConvert(trunks[3].c_str(),pitchYawRoll.y);
-    entity->SetPitchYawRollDegrees(pitchYawRoll);
+        Entity* entity = SpawnEntityForCreate(idx, typeName, mapName);
+        if (entity == nullptr) {
+            continue;
+        }
+
+        Vec3 pitchYawRoll = entity->GetEntityPitchYawRollDegrees();
+        pitchYawRoll.y = yaw;
+        entity->SetPosition(pos);
+        entity->SetPitchYawRollDegrees(pitchYawRoll);
+        if (entity->GetEntityType() == ENTITY_ACTOR && health >= 0.f) {
+            ((Actor*)entity)->SetHealth(health);
+        }
+        spawnedEntities.push_back(entity);
+    }
     return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool ParsePlayerInputMessage(std::string content, InputInfo& input)
+// sent after parsing the server tables whether or not they matched
+std::string MakeStringTableAckMessage(NetStringTables const& tables)
 {
-    Strings trunks = SplitStringOnDelimiter(content,';');
-    if (trunks.size() != 4) {
-        g_theConsole->PrintError(Stringf("Fail to parse player input content %s", content.c_str()));
-        return false;
+    std::string content;
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        content += Stringf(i == 0 ? "%u" : ";%u", tables.GetTable((eNetStringTableType)i).GetHash());
+    }
+
+    char header[MESSAGE_HEADER_LEN];
+    NetMessageHeader* headerPtr = reinterpret_cast<NetMessageHeader*>(&header[0]);
+    headerPtr->m_type = eNetMessageHeaderType::MESSAGE_STRING_TABLE_ACK;
+    headerPtr->m_size = (unsigned short)content.size();
+    headerPtr->m_seqNo = 0;
+
+    return std::string(header, MESSAGE_HEADER_LEN) + content;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// empty content from an older client means no tables
+bool ParseAddPlayerMessage(std::string_view content, std::vector<unsigned int>& tableHashes)
+{
+    tableHashes.clear();
+    if (content.empty()) {
+        return true;
     }
 
-    Strings rawPlayer = SplitStringOnDelimiter(trunks[0],',');
-    if (rawPlayer.size() != 2) {
-        g_theConsole->PrintError(Stringf("Fail to parse player move input %s",trunks[0].c_str()));
+    NetMessageReader reader(content);
+    unsigned long long hash = 0;
+    while (reader.ReadUnsigned(hash)) {
+        tableHashes.push_back((unsigned int)hash);
     }
-    else{
-        float playerMoveX = StringConvert(rawPlayer[0].c_str(), 0.f);
-        input.playerMove.x = Clamp(playerMoveX, -1.f, 1.f);
-        float playerMoveY = StringConvert(rawPlayer[1].c_str(), 0.f);
-        input.playerMove.y = Clamp(playerMoveY, -1.f, 1.f);
+    if (!reader.IsAtEnd() || tableHashes.size() != NUM_NET_STRING_TABLES) {
+        g_theConsole->PrintError(Stringf("Fail to parse add player %.*s", (int)content.size(), content.data()));
+        tableHashes.clear();
+        return false;
     }
+    return true;
+}
 
-    Strings rawMouse = SplitStringOnDelimiter(trunks[1], ',');
-    if (rawMouse.size() != 2) {
-        g_theConsole->PrintError(Stringf("Fail to parse mouse move input %s", trunks[1].c_str()));
+//////////////////////////////////////////////////////////////////////////
+// views in info point into content
+bool ParseHandshakePackage(std::string_view content, HandshakeInfo& info)
+{
+    NetMessageReader reader(content);
+    int step = -1;
+    unsigned long long nonce = 0;
+    unsigned long long token = 0;
+    bool isValid = reader.ReadInt(step) && step >= 0 && step < NUM_HANDSHAKE_STEPS && reader.ReadUnsigned(nonce);
+    if (isValid) {
+        info = HandshakeInfo();
+        info.step = (eHandshakeStep)step;
+        info.nonce = (unsigned int)nonce;
+        switch (info.step) {
+        case HANDSHAKE_REQUEST:     isValid = reader.ReadToken(info.replyIP) && reader.ReadInt(info.replyPort); break;
+        case HANDSHAKE_CHALLENGE:   isValid = reader.ReadUnsigned(token); break;
+        case HANDSHAKE_RESPONSE:    isValid = reader.ReadUnsigned(token, '|'); reader.ReadToken(info.addPlayer, '|'); break;
+        case HANDSHAKE_ACCEPT:      isValid = reader.ReadInt(info.identifier) && reader.ReadInt(info.pawnIndex); break;
+        }
+        info.token = (unsigned int)token;
     }
-    else{
-        float mouseMoveX = StringConvert(rawMouse[0].c_str(), 0.f);
-        input.mouseMove.x = Clamp(mouseMoveX, -1.f, 1.f);
-        float mouseMoveY = StringConvert(rawMouse[1].c_str(), 0.f);
-        input.mouseMove.y = Clamp(mouseMoveY, -1.f, 1.f);
+
+    if (!isValid) {
+        g_theConsole->PrintError(Stringf("Fail to parse handshake %.*s", (int)content.size(), content.data()));
+        return false;
     }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// adopt server tables, names arrive only where local ones differ
+bool ParseStringTableMessage(std::string_view content, NetStringTables& tables)
+{
+    NetMessageReader tableReader(content);
+    std::vector<std::string> names;
+    std::string_view rawTable;
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        if (!tableReader.ReadToken(rawTable, '|')) {
+            g_theConsole->PrintError(Stringf("Fail to parse string table %i", i));
+            return false;
+        }
+
+        eNetStringTableType type = (eNetStringTableType)i;
+        NetMessageReader reader(rawTable);
+        unsigned long long hash = 0;
+        std::string_view rawNames;
+        if (!reader.ReadUnsigned(hash) || !reader.ReadToken(rawNames) || !reader.IsAtEnd()) {
+            g_theConsole->PrintError(Stringf("Fail to parse string table %i", i));
+            return false;
+        }
 
-    int quit = StringConvert(trunks[2].c_str(),0);
-    input.isClosing = quit > 0;
+        if (rawNames != "=") {
+            names.clear();
+            NetMessageReader nameReader(rawNames);
+            std::string_view name;
+            while (!rawNames.empty() && nameReader.ReadToken(name, ',')) {
+                names.push_back(std::string(name));
+            }
+            tables.SetTable(type, names);
+        }
 
-    int fire = StringConvert(trunks[3].c_str(), 0);
-    input.isFiring = fire>0;
+        if (tables.GetTable(type).GetHash() != (unsigned int)hash) {
+            g_theConsole->PrintError(Stringf("String table %i hash mismatch, falling back to names", i));
+            return false;
+        }
+    }
 
+    tables.SetNegotiated(true);
     return true;
+}
 
+//////////////////////////////////////////////////////////////////////////
+// true only if remote reports the same hash for every table
+bool ParseStringTableAckMessage(std::string_view content, NetStringTables const& tables)
+{
+    NetMessageReader reader(content);
+    unsigned long long hash = 0;
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        if (!reader.ReadUnsigned(hash)) {
+            g_theConsole->PrintError(Stringf("Fail to parse string table ack %.*s", (int)content.size(), content.data()));
+            return false;
+        }
+        if ((unsigned int)hash != tables.GetTable((eNetStringTableType)i).GetHash()) {
+            return false;
+        }
+    }
+    return reader.IsAtEnd();
 }
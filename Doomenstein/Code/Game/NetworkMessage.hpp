@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 
 class Entity;
-class TCPServer;
-class TCPSocket;
+class NetStringTables;
 struct InputInfo;
 struct Vec2;
 
@@ -20,43 +23,113 @@ enum eNetMessageHeaderType : unsigned short
     MESSAGE_ENTITY_TELEPORT,
     MESSAGE_ACTOR_HEALTH,
     MESSAGE_SOUND_PLAY,
+    MESSAGE_PLAYER_STATE,
+    MESSAGE_CLOCK_SYNC_REQUEST,
+    MESSAGE_CLOCK_SYNC_RESPONSE,
+    MESSAGE_FRAGMENT,
+    MESSAGE_ENTITY_BASELINE,
+    MESSAGE_STRING_TABLE,
+    MESSAGE_STRING_TABLE_ACK,   //hashes of tables remote ended up with
 
-    MESSAGE_ACK
+    NUM_NET_MESSAGE_TYPES
 };
 
 struct NetMessageHeader
 {
     unsigned short m_type=0;
     unsigned short m_size=0;
-    unsigned short m_seqNo=0;
+    unsigned short m_seqNo=0;     //unused, reliable ids ride on packet acks
 };
 
 constexpr int MESSAGE_HEADER_LEN = (int)sizeof(NetMessageHeader);
 
+//server state of a client's own pawn after its last processed input
+struct PlayerStateInfo
+{
+    unsigned short lastInputSeq = 0;
+    float x = 0.f;
+    float y = 0.f;
+    float pitch = 0.f;
+    float yaw = 0.f;
+};
+
+//connectionless join, client repeats its step on a timer until the server answers
+enum eHandshakeStep : int
+{
+    HANDSHAKE_REQUEST=0,    //client: where to reply
+    HANDSHAKE_CHALLENGE,    //server: token to echo
+    HANDSHAKE_RESPONSE,     //client: echoed token plus add player content
+    HANDSHAKE_ACCEPT,       //server: packet key to use from now on
+
+    NUM_HANDSHAKE_STEPS
+};
+
+struct HandshakeInfo
+{
+    eHandshakeStep step = HANDSHAKE_REQUEST;
+    unsigned int nonce = 0;         //client picked, ties steps of one attempt together
+    unsigned int token = 0;         //server picked, proves client receives at its reply address
+    int identifier = 0;             //accept, packet key, never sent in any message payload
+    int pawnIndex = -1;             //accept, entity index the owner finds its pawn by
+    std::string_view replyIP;       //request
+    int replyPort = 0;              //request
+    std::string_view addPlayer;     //response
+};
+
+//encoded once, shared by every client it fans out to
+typedef std::shared_ptr<std::string const> SharedMessage;
+
+struct EntityTransformInfo
+{
+    int idx = -1;
+    float x = 0.f;
+    float y = 0.f;
+    float height = 0.f;
+    float pitch = 0.f;
+    float yaw = 0.f;
+};
+
 eNetMessageHeaderType GetHeaderTypeForMessage(std::string const& msg);
+char const* GetNameForMessageType(eNetMessageHeaderType type);
 unsigned short GetSeqNoForMessage(std::string const& msg);
-int GetEntityIdxFromOneTrunkMessage(std::string const& msg);
-int GetEntityIdxFromTwoChunksMessage(std::string const& msg);
-void GetEntityCreateInfoFromMessage(std::string const& msg, int& idx, std::string& type);
 
+SharedMessage MakeSharedMessage(std::string&& msg);
 std::string MakeMessageHeader(eNetMessageHeaderType type);
-std::string MakeCustomClientConnectPackage(std::string const& clientIP);
-std::string MakePlayerInputMessage(InputInfo const& input);
+std::string MakeHandshakePackage(HandshakeInfo const& info);
+int RollRandomUnusedPort();
+void ReleaseUsedPort(int port);
+int RollUnusedIdentifier();
+unsigned int RollSecretNumber();
+std::string MakePlayerInputMessage(std::vector<InputInfo> const& inputs);
 std::string MakeEntityTransformMessage(Entity const* entity);
-std::string MakeEntityCreateMessage(Entity const* entity);
-std::string MakeEntityTeleportMessage(Entity const* entity);
-std::string MakeEntityTeleportMessage(int entityIdx, std::string const& mapName);
+std::string MakeEntityCreateMessage(Entity const* entity, NetStringTables const* tables = nullptr);
+std::string MakeEntityTeleportMessage(Entity const* entity, NetStringTables const* tables = nullptr);
+std::string MakeEntityTeleportMessage(int entityIdx, std::string const& mapName, NetStringTables const* tables = nullptr);
 std::string MakeEntityDeleteMessage(int entityIdx);
-std::string MakeSoundPlayMessage(size_t id);
+std::string MakeSoundPlayMessage(size_t id, NetStringTables const* tables = nullptr);
 std::string MakeActorHealthMessage(int entityIdx, float newHealth);
-std::string MakeReliableACKMessage(unsigned short msgSeqNo);
-std::string MakeClientStartMessage(int udpToPort, int udpBindPort);
-
-bool ParseActorHealthMessage(std::string const& content);
-bool ParseEntityDeleteMessage(std::string const& content);
-bool ParseEntityTeleportMessage(std::string const& content);
-bool ParseClientConnectPackage(std::string const& content);
-bool ParseClientStartMessage(std::string const& content, TCPSocket* client);
-Entity* ParseEntityCreateMessage(std::string const& content);
-bool ParseEntityTransformMessage(std::string const& content);
-bool ParsePlayerInputMessage(std::string content, InputInfo& input);
+std::string MakePlayerStateMessage(Entity const* pawn, unsigned short lastInputSeq);
+std::string MakeClockSyncRequestMessage(double clientSendTime);
+std::string MakeClockSyncResponseMessage(double clientSendTime, double serverReceiveTime, double serverSendTime);
+std::string MakeEntityBaselineRecord(Entity const* entity, NetStringTables const* tables = nullptr);
+std::string MakeEntityBaselineMessage(std::string const& records);
+std::string MakeAddPlayerMessage(NetStringTables const& localTables);
+std::string MakeStringTableMessage(NetStringTables const& tables, std::vector<unsigned int> const& remoteHashes);
+std::string MakeStringTableAckMessage(NetStringTables const& tables);
+
+bool ParseActorHealthMessage(std::string_view content);
+bool ParseEntityDeleteMessage(std::string_view content, int& idx);
+bool ParseEntityTeleportMessage(std::string_view content);
+bool ParseHandshakePackage(std::string_view content, HandshakeInfo& info);
+Entity* ParseEntityCreateMessage(std::string_view content, std::unordered_set<int> const& deletedIndices);
+bool DecodeEntityTransformMessage(std::string_view content, EntityTransformInfo& info);
+bool ParseEntityTransformMessage(std::string_view content);
+bool ParsePlayerInputMessage(std::string_view content, std::vector<InputInfo>& inputs);
+bool ParseSoundPlayMessage(std::string_view content, size_t& id);
+bool ParsePlayerStateMessage(std::string_view content, PlayerStateInfo& state);
+bool ParseClockSyncRequestMessage(std::string_view content, double& clientSendTime);
+bool ParseClockSyncResponseMessage(std::string_view content, double& clientSendTime, double& serverReceiveTime, double& serverSendTime);
+bool ParseEntityBaselineMessage(std::string_view content, std::vector<Entity*>& spawnedEntities, std::unordered_set<int> const& deletedIndices);
+bool ParseAddPlayerMessage(std::string_view content, std::vector<unsigned int>& tableHashes);
+bool ParseStringTableMessage(std::string_view content, NetStringTables& tables);
+bool ParseStringTableAckMessage(std::string_view content, NetStringTables const& tables);
@@ -2,13 +2,32 @@
 #include "Game/NetworkMessage.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Server.hpp"
+#include "Game/Client.hpp"
 #include "Game/Entity.hpp"
 #include "Game/App.hpp"
+#include "Game/NetBufferReader.hpp"
+#include "Game/NetCompression.hpp"
+#include "Game/NetIOThread.hpp"
+#include "Game/NetTransport.hpp"
+#include "Game/LoopbackPeer.hpp"
+#include "Game/AuthoritativeServer.hpp"
+#include "Game/RemoteClient.hpp"
+#include "Game/Actor.hpp"
+#include "Game/EntityDefinition.hpp"
 #include "Engine/Network/NetworkCommon.hpp"
+#include "Engine/Network/Network.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+#include <algorithm>
+#include <fstream>
 
 static int udpFailNum = 0;
+static std::string reassembled;
+static std::string decompressed;
 
 //////////////////////////////////////////////////////////////////////////
 COMMAND(UDPReceiveFail, "receive UDP fail, quit", EVENT_NETWORK)
@@ -17,7 +36,7 @@ COMMAND(UDPReceiveFail, "receive UDP fail, quit", EVENT_NETWORK)
 
     if (g_theServer->m_isAuthoritative && udpFailNum>30) {
         void* udp = args.GetValue("ptr", (void*)nullptr);
-        Client* c = g_theServer->GetClientOfUDPSocket(static_cast<UDPSocket*>(udp));
+        Client* c = g_theServer->GetClientOfTransport(UDPTransport::GetTransportOfSocket(static_cast<UDPSocket*>(udp)));
         if (c) {
             g_theServer->RemovePlayer(c);
         }
@@ -29,60 +48,552 @@ COMMAND(UDPReceiveFail, "receive UDP fail, quit", EVENT_NETWORK)
 }
 
 //////////////////////////////////////////////////////////////////////////
+// engine reads sockets and fires this on the main thread during its begin frame,
+// so the stamp is when the game got the packet, not when the socket did
 COMMAND(UDPSocketReceive, "received udp socket, data=... ptr=&(UDPSocket)", EVENT_NETWORK)
 {
+    double receiveTime = GetCurrentTimeSeconds();
     udpFailNum = 0;
 
     std::string data = args.GetValue("data","");
-    if (data.empty()) {
+    UDPSocket* soc = static_cast<UDPSocket*>(args.GetValue("ptr", (void*)nullptr));
+    return g_theObserver->ReceivePacket(UDPTransport::GetTransportOfSocket(soc), data, receiveTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetPriorityStats, "print per client transform priority and starvation stats", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    if (!g_theServer->m_isAuthoritative) {
+        g_theConsole->PrintError("Priority stats only available on server");
         return false;
     }
 
-    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&data[0]);
-    int identifier = headerPtr->m_key;
-    bool reliable = headerPtr->m_reliable;
-    if (headerPtr->m_type == eNetworkPackageHeaderType::HEAD_CLIENT_CLOSE) {
-        g_theServer->RemovePlayerOfIdentifier(identifier);  //quit not reliable
-        return true;
+    for (Client* c : g_theServer->m_clients) {
+        if (!c->m_isRemote) {
+            continue;
+        }
+
+        PriorityStats const& stats = c->m_priority.GetStats();
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: budget %i bytes, last used %i, sent %i, deferred %i",
+            c->m_identifier, c->m_sendBudgetBytes, stats.lastBytesUsed, stats.sentUpdates, stats.deferredUpdates));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    starving %i, max wait %i sends (%.2fs), dirty %i",
+            stats.starvedEntities, stats.maxSendsWaited, stats.maxSecondsWaited, (int)c->m_priority.GetDirtyCount()));
     }
-    else if(headerPtr->m_type==eNetworkPackageHeaderType::HEAD_TEXT){    
-        std::string messages = std::string(&data[NET_HEADER_LEN], headerPtr->m_size);
-        while(!messages.empty()){
-            NetMessageHeader* header = reinterpret_cast<NetMessageHeader*>(&messages[0]);
-            g_theServer->HandleUDPMessageOfIdentifier(*header, std::string(&messages[MESSAGE_HEADER_LEN], header->m_size), identifier,reliable);
-            messages = messages.substr(MESSAGE_HEADER_LEN + header->m_size);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetPredictionStats, "print own pawn prediction and correction stats", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    if (g_theServer->m_isAuthoritative || g_theServer->m_clients.empty()) {
+        g_theConsole->PrintError("Prediction stats only available on remote client");
+        return false;
+    }
+
+    InputPredictor const& predictor = g_theServer->m_clients[0]->m_predictor;
+    PredictionStats const& stats = predictor.GetStats();
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("predicted %i, pending %i, corrections %i, replayed %i",
+        stats.predictedInputs, (int)predictor.GetPendingCount(), stats.corrections, stats.replayedInputs));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("last correction %.3f, max correction %.3f",
+        stats.lastCorrectionDist, stats.maxCorrectionDist));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetInputStats, "print per client input queue depth and starvation stats", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    if (!g_theServer->m_isAuthoritative) {
+        g_theConsole->PrintError("Input stats only available on server");
+        return false;
+    }
+
+    for (Client* c : g_theServer->m_clients) {
+        if (!c->m_isRemote) {
+            continue;
         }
+
+        InputJitterBuffer const& buffer = c->m_inputBuffer;
+        InputBufferStats const& stats = buffer.GetStats();
+        double avgDepth = stats.depthSamples > 0 ? stats.depthSecondsSum / (double)stats.depthSamples : 0.0;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: depth %i inputs %.1fms, target %.1fms, avg %.1fms, max %.1fms",
+            c->m_identifier, buffer.GetDepth(), buffer.GetBufferedSeconds() * 1000.f, buffer.GetTargetSeconds() * 1000.f,
+            avgDepth * 1000.0, stats.maxDepthSeconds * 1000.f));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    received %i, consumed %i, starved ticks %i, lost %i, overflow %i, caught up %.1fms",
+            stats.receivedInputs, stats.consumedInputs, stats.starvedTicks, stats.lostInputs, stats.overflowInputs, stats.catchUpSeconds * 1000.f));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetProjectileStats, "print transform updates and bytes saved by spawn only projectiles", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    if (!g_theServer->m_isAuthoritative) {
+        g_theConsole->PrintError("Projectile stats only available on server");
+        return false;
+    }
+
+    //estimate with average transform message size actually sent
+    long long sentBytes = 0;
+    long long sentUpdates = 0;
+    for (Client* c : g_theServer->m_clients) {
+        sentBytes += c->m_priority.GetStats().sentBytes;
+        sentUpdates += c->m_priority.GetStats().sentUpdates;
+    }
+    long long skipped = g_theObserver->GetSkippedProjectileUpdates();
+    double avgBytes = sentUpdates > 0 ? (double)sentBytes / (double)sentUpdates : 0.0;
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("skipped %lld projectile transforms, ~%.0f bytes saved (avg %.1f bytes each)",
+        skipped, (double)skipped * avgBytes, avgBytes));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("sent %lld other transforms, %lld bytes", sentUpdates, sentBytes));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// bytes the server sends to firing bots, per flight transforms against spawn and delete only
+COMMAND(NetFirefightBench, "bot firefight bandwidth with and without projectile transforms, bots=6 seconds=10 seed=1", eEventFlag::EVENT_CONSOLE)
+{
+    int count = args.GetValue("bots", 6);
+    float seconds = args.GetValue("seconds", 10.f);
+    int seed = args.GetValue("seed", 1);
+    if (!g_theServer->m_isAuthoritative || count <= 0 || seconds <= 0.f) {
+        g_theConsole->PrintError("Firefight bench needs an authoritative server, bots > 0 and seconds > 0");
+        return false;
+    }
+
+    g_theObserver->SetLoopbackPeerCount(0);
+    g_theObserver->SetLoopbackPeerCount(count);
+    std::vector<LoopbackPeer*> const& peers = g_theObserver->GetLoopbackPeers();
+    for (size_t i = 0; i < peers.size(); i++) {
+        peers[i]->SetInputPattern(BOT_INPUT_FIREFIGHT, (unsigned int)seed + (unsigned int)i);
+    }
+    g_theObserver->StartFirefightBench(seconds);
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i firing bots, results after join and %.0fs per phase", count, seconds));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetSendRates, "print per connection rtt, jitter, loss and adapted send rate", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    for (Client* c : g_theServer->m_clients) {
+        if (c->m_transport == nullptr) {
+            continue;
+        }
+
+        ConnectionStats const& stats = c->m_connection.GetStats();
+        SendRateController const& rate = c->m_sendRate;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: rtt %.1fms, jitter %.1fms, min %.1fms, loss %.1f%%",
+            c->m_identifier, stats.rtt * 1000.f, stats.rttVar * 1000.f, stats.minRtt * 1000.f, stats.lossRate * 100.f));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    rate %.1f/%.1f Hz, budget %i bytes, %s, backoffs %i, sent %lld, acked %lld, lost %lld",
+            rate.GetSendRate(), g_sendRatePerSec, rate.GetByteBudget(), rate.IsCongested() ? "congested" : "clear",
+            rate.GetDecreaseCount(), stats.sentPackets, stats.ackedPackets, stats.lostPackets));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetStats, "print per connection rtt, loss, packet rates, reliable backlog, retransmits and bytes by message type", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    int typeOrder[NUM_NET_MESSAGE_TYPES];
+    for (Client* c : g_theServer->m_clients) {
+        if (c->m_transport == nullptr) {
+            continue;
+        }
+
+        ConnectionMetricsStats const& stats = c->m_metrics.GetStats();
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: %s", c->m_identifier, c->m_metrics.MakeSummary(c->m_connection.GetStats()).c_str()));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    sent %lld packets %lld bytes, received %lld packets %lld bytes, %lld retransmits",
+            stats.sentPackets, stats.sentBytes, stats.receivedPackets, stats.receivedBytes, stats.retransmits));
+
+        //heaviest message types first
+        for (int i = 0; i < NUM_NET_MESSAGE_TYPES; i++) {
+            typeOrder[i] = i;
+        }
+        std::sort(typeOrder, typeOrder + NUM_NET_MESSAGE_TYPES, [&stats](int a, int b) {
+            return stats.messageTypes[a].sentBytes > stats.messageTypes[b].sentBytes;
+        });
+        std::string typeText;
+        for (int i = 0; i < NUM_NET_MESSAGE_TYPES; i++) {
+            MessageTypeMetrics const& type = stats.messageTypes[typeOrder[i]];
+            if (type.sentMessages == 0) {
+                break;
+            }
+            typeText += Stringf("%s%s %lld (%lld bytes)", typeText.empty() ? "" : ", ",
+                GetNameForMessageType((eNetMessageHeaderType)typeOrder[i]), type.sentMessages, type.sentBytes);
+        }
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    by type: %s", typeText.empty() ? "nothing sent" : typeText.c_str()));
+    }
+    if (g_theObserver->GetDroppedUnknownPackets() > 0) {
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Dropped %lld packets of unknown header type", g_theObserver->GetDroppedUnknownPackets()));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetStatsOverlay, "show per connection net stats on screen, enabled=true|false, F2 toggles", eEventFlag::EVENT_CONSOLE)
+{
+    g_showNetStats = args.GetValue("enabled", !g_showNetStats);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetStatsDump, "append per connection stats as json lines, file=netstats.jsonl interval=1 seconds, 0 stops", eEventFlag::EVENT_CONSOLE)
+{
+    std::string path = args.GetValue("file", "netstats.jsonl");
+    float interval = args.GetValue("interval", 1.f);
+    if (interval < 0.f || path.empty()) {
+        g_theConsole->PrintError("NetStatsDump needs a file and an interval not negative");
+        return false;
+    }
+
+    g_theObserver->SetStatsDump(path, interval);
+    g_theConsole->PrintString(Rgba8::WHITE, interval > 0.f ? Stringf("Dumping net stats to %s every %.2fs", path.c_str(), interval) : "Net stats dump stopped");
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetFragmentStats, "print per client fragmented sends and reassembly stats", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    for (Client* c : g_theServer->m_clients) {
+        FragmentStats const& stats = c->m_fragments.GetStats();
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: fragmented sends %i, fragments received %i, completed %i",
+            c->m_identifier, c->m_fragmentedSends, stats.receivedFragments, stats.completedMessages));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    pending %i (%i bytes, peak %i), timed out %i, evicted %i, duplicates %i, invalid %i",
+            c->m_fragments.GetPendingCount(), c->m_fragments.GetPendingBytes(), stats.maxPendingBytes, stats.timedOutMessages,
+            stats.evictedMessages, stats.duplicateFragments, stats.invalidFragments));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetJoinStats, "print per client join baseline progress, join time and peak burst", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    for (Client* c : g_theServer->m_clients) {
+        if (!c->m_isRemote) {
+            continue;
+        }
+
+        BaselineStreamer const& baseline = c->m_baseline;
+        BaselineStats const& stats = baseline.GetStats();
+        double joinSeconds = baseline.IsReady() ? stats.readyTime - stats.startTime : GetCurrentTimeSeconds() - stats.startTime;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: %s, %i entities in %i chunks (%i bytes), %i bytes unacked",
+            c->m_identifier, baseline.IsReady() ? "ready" : (baseline.IsStreaming() ? "joining" : "not joined"),
+            stats.entityCount, stats.chunkCount, stats.sentBytes, baseline.GetInFlightBytes()));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    join time %.0fms, peak burst %i bytes in %i packets",
+            joinSeconds * 1000.0, stats.peakBurstBytes, stats.peakBurstPackets));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetStringTableStats, "print negotiated def, map and sound string tables", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    static char const* tableNames[NUM_NET_STRING_TABLES] = {"entity defs", "maps", "sounds"};
+    NetStringTables const& tables = g_theServer->m_stringTables;
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("String tables %s", tables.IsNegotiated() ? "negotiated" : "not negotiated, sending names"));
+    for (int i = 0; i < NUM_NET_STRING_TABLES; i++) {
+        NetStringTable const& table = tables.GetTable((eNetStringTableType)i);
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    %s: %i names, hash %08x", tableNames[i], (int)table.GetNames().size(), table.GetHash()));
+    }
+
+    if (g_theServer->m_isAuthoritative) {
+        for (Client* c : g_theServer->m_clients) {
+            if (c->m_isRemote) {
+                g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: %s", c->m_identifier, c->HasStringTable() ? "using ids" : "using names"));
+            }
+        }
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetIOThreadStats, "print network io thread queue depth and send cost", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    NetIOStats stats = g_theNetIO->GetStats();
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("IO thread: %lld queued, %lld sent, max depth %i/%i, %lld parked on full queue (max %i)",
+        stats.queuedPackets, stats.sentPackets, stats.maxQueueDepth, NET_IO_QUEUE_SIZE, stats.overflowPackets, stats.maxOverflowDepth));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    %.2fus per send, max queue wait %.3fms",
+        stats.sentPackets > 0 ? stats.sendSeconds * 1000000.0 / (double)stats.sentPackets : 0.0, stats.maxQueueSeconds * 1000.0));
+    double frames = stats.submittedBatches > 0 ? (double)stats.submittedBatches : 1.0;
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    per frame: %.2f socket sends, %.2f notifies, %.2f io thread wakeups, %.2f batches (max batch %i)",
+        (double)stats.sentPackets / frames, (double)stats.wakeCalls / frames, (double)stats.threadWakeups / frames,
+        (double)stats.sentBatches / frames, stats.maxBatchSize));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    avg queue delay %.3fms, max late past release %.3fms, max held %i",
+        stats.sentPackets > 0 ? stats.totalQueueSeconds * 1000.0 / (double)stats.sentPackets : 0.0, stats.maxLateSeconds * 1000.0, stats.maxHeldPackets));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetClockSync, "print estimated server clock offset, delay and drift", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    if (g_theServer->m_isAuthoritative) {
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Authoritative server: tick %u, time %.3f", 
+            g_theServer->m_tick, g_theServer->GetServerTime()));
         return true;
     }
 
-    //TODO not handled other type of package
-    return false;
+    for (Client* c : g_theServer->m_clients) {
+        ClockSync const& sync = c->m_clockSync;
+        if (!sync.IsSynced()) {
+            g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: clock not synced yet", c->m_identifier));
+            continue;
+        }
+
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Client %i: offset %.2fms, delay %.2fms, drift %.1fppm, samples %i",
+            c->m_identifier, sync.GetOffset() * 1000.0, sync.GetDelay() * 1000.0, sync.GetDrift() * 1000000.0, sync.GetSampleCount()));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    server tick %u, estimated server time %.3f",
+            g_theServer->m_tick, g_theServer->GetServerTime()));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static void PrintNetSimDirection(NetSimulator const& sim, eNetSimDirection direction)
+{
+    NetSimSettings const& settings = sim.GetSettings(direction);
+    NetSimStats const& stats = sim.GetStats(direction);
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%s: latency %.0fms, jitter %.0fms, loss %.1f%%, dup %.1f%%, reorder %.1f%%, bandwidth %s",
+        direction == NET_SIM_OUTGOING ? "Out" : "In", settings.latencyMs, settings.jitterMs, settings.lossPercent,
+        settings.duplicatePercent, settings.reorderPercent, settings.bandwidthKbps > 0 ? Stringf("%ikbps", settings.bandwidthKbps).c_str() : "unlimited"));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    %lld submitted, %lld released (avg delay %.1fms), %lld lost, %lld overflow, %lld duplicated, %lld reordered, %i held",
+        stats.submittedPackets, stats.releasedPackets, stats.releasedPackets > 0 ? stats.totalDelaySeconds * 1000.0 / (double)stats.releasedPackets : 0.0,
+        stats.lostPackets, stats.overflowPackets, stats.duplicatedPackets, stats.reorderedPackets, sim.GetHeldPacketCount(direction)));
 }
 
 //////////////////////////////////////////////////////////////////////////
-void PackUpMessages(std::vector<std::string> const& msgs, std::queue<std::string>& packages, bool reliable)
+// unspecified values keep their current setting, no arguments just prints
+COMMAND(NetSim, "impair traffic, dir=both|out|in latency=ms jitter=ms loss=% dup=% reorder=% bandwidth=kbps seed=1", eEventFlag::EVENT_CONSOLE)
 {
-    std::string curPack;
-    for (size_t i = 0; i < msgs.size(); i++) {
-        std::string const& pack = msgs[i];
-        //TODO not handled package len > message length
-        if (curPack.size() + pack.size() <= NET_MAX_DATA_LEN) {
-            curPack += pack;
+    NetSimulator& sim = g_theObserver->GetSimulator();
+    std::string dir = args.GetValue("dir", "both");
+    if (dir != "both" && dir != "out" && dir != "in") {
+        g_theConsole->PrintError(Stringf("Invalid NetSim dir %s, use both, out or in", dir.c_str()));
+        return false;
+    }
+
+    for (int i = 0; i < NUM_NET_SIM_DIRECTIONS; i++) {
+        eNetSimDirection direction = (eNetSimDirection)i;
+        if ((direction == NET_SIM_OUTGOING && dir == "in") || (direction == NET_SIM_INCOMING && dir == "out")) {
+            continue;
         }
-        else {
-            packages.push(MakeTextPackage(curPack, reliable));
-            curPack = pack;
+
+        NetSimSettings settings = sim.GetSettings(direction);
+        settings.latencyMs = args.GetValue("latency", settings.latencyMs);
+        settings.jitterMs = args.GetValue("jitter", settings.jitterMs);
+        settings.lossPercent = args.GetValue("loss", settings.lossPercent);
+        settings.duplicatePercent = args.GetValue("dup", settings.duplicatePercent);
+        settings.reorderPercent = args.GetValue("reorder", settings.reorderPercent);
+        settings.bandwidthKbps = args.GetValue("bandwidth", settings.bandwidthKbps);
+        if (settings.latencyMs < 0.f || settings.jitterMs < 0.f || settings.lossPercent < 0.f ||
+            settings.duplicatePercent < 0.f || settings.reorderPercent < 0.f || settings.bandwidthKbps < 0) {
+            g_theConsole->PrintError("NetSim values can not be negative");
+            return false;
+        }
+        sim.SetSettings(direction, settings);
+    }
+
+    int seed = args.GetValue("seed", -1);
+    if (seed >= 0) {
+        sim.SetSeed((unsigned int)seed);
+        sim.ResetStats();
+    }
+
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("Network simulator, seed %u", sim.GetSeed()));
+    PrintNetSimDirection(sim, NET_SIM_OUTGOING);
+    PrintNetSimDirection(sim, NET_SIM_INCOMING);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetSimOff, "stop impairing traffic, held packets still go out when due", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    NetSimulator& sim = g_theObserver->GetSimulator();
+    sim.SetSettings(NET_SIM_OUTGOING, NetSimSettings());
+    sim.SetSettings(NET_SIM_INCOMING, NetSimSettings());
+    g_theConsole->PrintString(Rgba8::WHITE, "Network simulator off");
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// unspecified values keep their current setting, no arguments just prints
+COMMAND(NetPacing, "spread sends over the frame, enabled=true|false burst=bytes total=kbps totalburst=bytes reset=false", eEventFlag::EVENT_CONSOLE)
+{
+    NetPacer& pacer = g_theObserver->GetPacer();
+    NetPaceSettings settings = pacer.GetSettings();
+    settings.isEnabled = args.GetValue("enabled", settings.isEnabled);
+    settings.connectionBurstBytes = args.GetValue("burst", settings.connectionBurstBytes);
+    settings.totalKbps = args.GetValue("total", settings.totalKbps);
+    settings.totalBurstBytes = args.GetValue("totalburst", settings.totalBurstBytes);
+    if (settings.connectionBurstBytes <= 0.f || settings.totalBurstBytes <= 0.f || settings.totalKbps < 0) {
+        g_theConsole->PrintError("NetPacing bursts must be positive and total not negative");
+        return false;
+    }
+    pacer.SetSettings(settings);
+    if (args.GetValue("reset", false)) {
+        pacer.ResetStats();
+    }
+
+    NetPaceStats const& stats = pacer.GetStats();
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("Pacing %s: window %.1fms, connection burst %.0f bytes, total %s, total burst %.0f bytes",
+        settings.isEnabled ? "on" : "off", pacer.GetWindow() * 1000.f, settings.connectionBurstBytes,
+        settings.totalKbps > 0 ? Stringf("%ikbps", settings.totalKbps).c_str() : "unlimited", settings.totalBurstBytes));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    %lld scheduled, %lld throttled by a bucket, avg delay %.2fms, max delay %.2fms",
+        stats.scheduledPackets, stats.throttledPackets,
+        stats.scheduledPackets > 0 ? stats.totalDelaySeconds * 1000.0 / (double)stats.scheduledPackets : 0.0, stats.maxDelaySeconds * 1000.0));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetLoopbackClients, "run in process protocol clients on the server, clients=4, 0 disconnects all", eEventFlag::EVENT_CONSOLE)
+{
+    int count = args.GetValue("clients", 4);
+    if (!g_theServer->m_isAuthoritative || count < 0) {
+        g_theConsole->PrintError("Loopback clients need an authoritative server and clients >= 0");
+        return false;
+    }
+
+    g_theObserver->SetLoopbackPeerCount(count);
+    double now = GetCurrentTimeSeconds();
+    for (LoopbackPeer const* peer : g_theObserver->GetLoopbackPeers()) {
+        LoopbackPeerStats const& stats = peer->GetStats();
+        ConnectionStats const& connection = peer->GetConnectionStats();
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Peer %i: %s, joined %.0fms, rtt %.1fms, sent %lld packets (%lld bytes), received %lld packets (%lld bytes, %lld messages), %lld corrupt",
+            peer->GetIdentifier(), !peer->IsConnected() ? "disconnected" : (peer->IsReady() ? "ready" : "joining"),
+            ((peer->IsReady() ? stats.readyTime : now) - stats.joinTime) * 1000.0, connection.rtt * 1000.f,
+            stats.sentPackets, stats.sentBytes, stats.receivedPackets, stats.receivedBytes, stats.receivedMessages, stats.corruptPackets));
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetBots, "drive loopback clients as load bots, bots=64 pattern=none|random|circle|strafe|firefight seed=1", eEventFlag::EVENT_CONSOLE)
+{
+    int count = args.GetValue("bots", 64);
+    std::string patternName = args.GetValue("pattern", "random");
+    int seed = args.GetValue("seed", 1);
+    eBotInputPattern pattern = GetBotInputPatternForName(patternName);
+    if (!g_theServer->m_isAuthoritative || count < 0) {
+        g_theConsole->PrintError("Bots need an authoritative server and bots >= 0");
+        return false;
+    }
+    if (pattern == BOT_INPUT_NONE && patternName != "none") {
+        g_theConsole->PrintError(Stringf("Unknown bot pattern %s", patternName.c_str()));
+        return false;
+    }
+
+    g_theObserver->SetLoopbackPeerCount(count);
+    std::vector<LoopbackPeer*> const& peers = g_theObserver->GetLoopbackPeers();
+    for (size_t i = 0; i < peers.size(); i++) {
+        peers[i]->SetInputPattern(pattern, (unsigned int)seed + (unsigned int)i);
+    }
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i bots with %s input, seed %i, NetBotStats to report",
+        (int)peers.size(), GetNameForBotInputPattern(pattern), seed));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// run from a second game process, the server sees ordinary udp clients
+COMMAND(NetBotsConnect, "load bots joining a server over udp, ip=127.0.0.1 port=48000 replyip=127.0.0.1 bots=16 pattern=random seed=1", eEventFlag::EVENT_CONSOLE)
+{
+    std::string ip = args.GetValue("ip", "127.0.0.1");
+    int port = args.GetValue("port", 48000);
+    std::string replyIP = args.GetValue("replyip", "127.0.0.1");
+    int count = args.GetValue("bots", 16);
+    std::string patternName = args.GetValue("pattern", "random");
+    int seed = args.GetValue("seed", 1);
+    eBotInputPattern pattern = GetBotInputPatternForName(patternName);
+    if (count <= 0) {
+        g_theConsole->PrintError("Bots need bots > 0");
+        return false;
+    }
+    if (pattern == BOT_INPUT_NONE && patternName != "none") {
+        g_theConsole->PrintError(Stringf("Unknown bot pattern %s", patternName.c_str()));
+        return false;
+    }
+
+    g_theObserver->SetLoopbackPeerCount(0);
+    g_theObserver->ConnectUDPPeers(ip, port, replyIP, count);
+    std::vector<LoopbackPeer*> const& peers = g_theObserver->GetLoopbackPeers();
+    for (size_t i = 0; i < peers.size(); i++) {
+        peers[i]->SetInputPattern(pattern, (unsigned int)seed + (unsigned int)i);
+    }
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i udp bots with %s input joining %s:%i, NetBotStats to report",
+        (int)peers.size(), GetNameForBotInputPattern(pattern), ip.c_str(), port));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetBotStats, "print per bot rtt, received bandwidth and desync counts", eEventFlag::EVENT_CONSOLE)
+{
+    UNUSED(args);
+
+    double now = GetCurrentTimeSeconds();
+    int readyCount = 0;
+    long long totalDesyncs = 0;
+    float rttSum = 0.f;
+    float maxRtt = 0.f;
+    double kbpsSum = 0.0;
+    std::vector<LoopbackPeer*> const& peers = g_theObserver->GetLoopbackPeers();
+    for (LoopbackPeer const* peer : peers) {
+        LoopbackPeerStats const& stats = peer->GetStats();
+        ConnectionStats const& connection = peer->GetConnectionStats();
+        double seconds = now - stats.joinTime;
+        double kbps = seconds > 0.0 ? (double)stats.receivedBytes * 8.0 / 1000.0 / seconds : 0.0;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Bot %i: %s %s, rtt %.1fms, received %.1fkbps, inputs %lld, desyncs %lld (%lld unknown entity, %lld input ahead), %lld stale states",
+            peer->GetIdentifier(), GetNameForBotInputPattern(peer->GetInputPattern()),
+            !peer->IsConnected() ? "disconnected" : (peer->IsReady() ? "ready" : "joining"),
+            connection.rtt * 1000.f, kbps, stats.sentInputs, stats.GetDesyncCount(),
+            stats.unknownEntityUpdates, stats.inputEchoesAhead, stats.staleStates));
+
+        if (peer->IsReady()) {
+            readyCount++;
         }
+        totalDesyncs += stats.GetDesyncCount();
+        rttSum += connection.rtt;
+        maxRtt = connection.rtt > maxRtt ? connection.rtt : maxRtt;
+        kbpsSum += kbps;
     }
-    if (!curPack.empty()) {
-        packages.push(MakeTextPackage(curPack, reliable));
+
+    if (peers.empty()) {
+        g_theConsole->PrintString(Rgba8::WHITE, "No bots, start with NetBots or NetBotsConnect");
+        return true;
     }
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i/%i bots ready, avg rtt %.1fms, max rtt %.1fms, total received %.1fkbps, %lld desyncs",
+        readyCount, (int)peers.size(), rttSum / (float)peers.size() * 1000.f, maxRtt * 1000.f, kbpsSum, totalDesyncs));
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
 NetworkObserver::NetworkObserver()
 {
-    m_sendTimer.SetTimerSeconds(1.0 / (double)g_sendRatePerSec);
+}
+
+//////////////////////////////////////////////////////////////////////////
+NetworkObserver::~NetworkObserver()
+{
+    SetLoopbackPeerCount(0);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -97,6 +608,17 @@ void NetworkObserver::AddEntityTransformUpdate(Entity* entity)
     m_entityTransformChanged.push_back(entity);
 }
 
+//////////////////////////////////////////////////////////////////////////
+void NetworkObserver::RemoveEntityTransformUpdate(int entityIdx)
+{
+    for (size_t i = 0; i < m_entityTransformChanged.size(); i++) {
+        if (m_entityTransformChanged[i]->GetIndex() == entityIdx) {
+            m_entityTransformChanged.erase(m_entityTransformChanged.begin() + i);
+            return;
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 void NetworkObserver::AddSoundPlay(size_t id)
 {
@@ -112,7 +634,7 @@ void NetworkObserver::AddSoundPlay(size_t id)
 //////////////////////////////////////////////////////////////////////////
 void NetworkObserver::AddMessage(std::string const& package)
 {
-    m_messages.push_back(package);
+    m_messages.push_back(MakeSharedMessage(std::string(package)));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -121,41 +643,375 @@ void NetworkObserver::Restart()
     m_entityTransformChanged.clear();
     m_SFXToPlay.clear();
     m_messages.clear();
+    SetLoopbackPeerCount(0);
+}
 
-    std::queue<std::string> emptyQueue;
-    m_packages.swap(emptyQueue);
+//////////////////////////////////////////////////////////////////////////
+void NetworkObserver::BeginFrame()
+{
+    double now = GetCurrentTimeSeconds();
+    for (LoopbackPeer* peer : m_loopbackPeers) {
+        peer->Update(now);
+    }
+    UpdateFirefightBench(now);
+
+    //udp transports have nothing here, their packets come by event
+    for (size_t i = 0; i < g_theServer->m_clients.size(); i++) {
+        Client* c = g_theServer->m_clients[i];
+        NetTransport* transport = c->m_transport;
+        while (transport && c->m_transport == transport && transport->Receive(m_receiveBuffer)) {
+            ReceivePacket(transport, m_receiveBuffer, GetCurrentTimeSeconds());
+        }
+    }
+
+    ReleaseSimulatedPackets(NET_SIM_INCOMING, GetCurrentTimeSeconds());
+}
+
+//////////////////////////////////////////////////////////////////////////
+// authoritative only, new peers join through the same add player path as udp clients
+void NetworkObserver::SetLoopbackPeerCount(int count)
+{
+    while ((int)m_loopbackPeers.size() > count) {
+        LoopbackPeer* peer = m_loopbackPeers.back();
+        peer->Disconnect();
+        //simulator may still hold packets received for a udp bot, dropped with its transport
+        ForgetTransport(peer->GetTransport());
+        m_peerOfUDPTransport.erase(peer->GetTransport());
+        delete peer;
+        m_loopbackPeers.pop_back();
+    }
+
+    if (g_theServer == nullptr || !g_theServer->m_isAuthoritative) {
+        return;
+    }
+
+    AuthoritativeServer* server = (AuthoritativeServer*)g_theServer;
+    while ((int)m_loopbackPeers.size() < count) {
+        LoopbackTransport* peerTransport = nullptr;
+        RemoteClient* client = server->ConnectLoopbackClient(peerTransport);
+        LoopbackPeer* peer = new LoopbackPeer(peerTransport, client->m_identifier);
+        peer->Join(GetCurrentTimeSeconds());
+        m_loopbackPeers.push_back(peer);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// meant for a second game process, so bots pay for sockets, handshake and
+// compression on their own cpu instead of sharing the server's frame
+void NetworkObserver::ConnectUDPPeers(std::string const& serverIP, int serverPort, std::string const& replyIP, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int replyPort = RollRandomUnusedPort();
+        UDPTransport* transport = new UDPTransport(g_theNetwork->CreateUDPSocket(serverIP, serverPort, replyPort));
+        LoopbackPeer* peer = new LoopbackPeer(transport, 0);
+        m_loopbackPeers.push_back(peer);
+        if (!transport->IsValid()) {
+            g_theConsole->PrintError(Stringf("Fail to bind udp port %i for bot", replyPort));
+            continue;
+        }
+
+        m_peerOfUDPTransport[transport] = peer;
+        peer->Connect(replyIP, replyPort, GetCurrentTimeSeconds());
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// outgoing side of the simulator, packets skip it entirely while it is off
+// bytesPerSec is the connection's pacing rate, 0 leaves only the total limit
+void NetworkObserver::SendPacket(NetTransport* transport, std::string const& packet, float bytesPerSec, bool isTimeCritical)
+{
+    QueuePacket(transport, packet, SchedulePacket(transport, (int)packet.size(), bytesPerSec, isTimeCritical));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// packets headed into the simulator are paced as it releases them, its delay is the network's
+double NetworkObserver::SchedulePacket(NetTransport* transport, int bytes, float bytesPerSec, bool isTimeCritical)
+{
+    double now = GetCurrentTimeSeconds();
+    if (m_simulator.IsEnabled(NET_SIM_OUTGOING)) {
+        return now;
+    }
+
+    return m_pacer.Schedule(transport, bytes, bytesPerSec, now, isTimeCritical);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetworkObserver::QueuePacket(NetTransport* transport, std::string const& packet, double releaseTime)
+{
+    if (m_simulator.IsEnabled(NET_SIM_OUTGOING)) {
+        m_simulator.Submit(NET_SIM_OUTGOING, transport, packet, GetCurrentTimeSeconds());
+        return;
+    }
+
+    g_theNetIO->QueuePacket(transport, packet, releaseTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one received packet from any transport, same path for udp and loopback
+bool NetworkObserver::ReceivePacket(NetTransport* source, std::string& data, double receiveTime)
+{
+    if (m_simulator.IsEnabled(NET_SIM_INCOMING)) {
+        m_simulator.Submit(NET_SIM_INCOMING, source, data, receiveTime);
+        return true;
+    }
+
+    return DeliverPacket(source, data, receiveTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetworkObserver::ForgetTransport(NetTransport* transport)
+{
+    m_simulator.ForgetTransport(transport);
+    m_pacer.ForgetTransport(transport);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// held packets are released at frame granularity, receive is stamped with their due time
+void NetworkObserver::ReleaseSimulatedPackets(eNetSimDirection direction, double now)
+{
+    while (m_simulator.PopDuePacket(direction, now, m_simPacket)) {
+        if (direction == NET_SIM_OUTGOING) {
+            double release = m_pacer.Schedule(m_simPacket.transport, (int)m_simPacket.data.size(), 0.f, now);
+            g_theNetIO->QueuePacket(m_simPacket.transport, m_simPacket.data, release);
+        }
+        else {
+            DeliverPacket(m_simPacket.transport, m_simPacket.data, m_simPacket.releaseTime);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool NetworkObserver::DeliverPacket(NetTransport* source, std::string& data, double receiveTime)
+{
+    //loopback and simulator packets come here too, nothing is read before the header fits
+    if (data.size() < NET_HEADER_LEN) {
+        return false;
+    }
+
+    //udp bots of this process take their server's packets themselves
+    auto peerFound = m_peerOfUDPTransport.find(source);
+    if (peerFound != m_peerOfUDPTransport.end()) {
+        peerFound->second->ReceivePacket(data, receiveTime);
+        return true;
+    }
+
+    //demultiplex on the packet key, only accepted from the transport it was handed out on
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&data[0]);
+    int identifier = headerPtr->m_key;
+    if (headerPtr->m_type == eNetworkPackageHeaderType::HEAD_CLIENT_CLOSE) {
+        //a key that never sent ordinary traffic can't be closed, the listen socket has no source to check
+        Client* c = g_theServer->GetClientOfPacket(identifier, source);
+        if (c && c->m_isRemote && c->m_lastReceiveTime > 0.0) {
+            g_theServer->RemovePlayer(c);  //quit not reliable
+        }
+        else if (c && !c->m_isQuiting && !g_theServer->m_isAuthoritative) {
+            g_theServer->RemovePlayer(c);  //server went away
+        }
+        return true;
+    }
+    else if (headerPtr->m_type == eNetworkPackageHeaderType::HEAD_CLIENT_START || headerPtr->m_type == eNetworkPackageHeaderType::HEAD_SERVER_LISTEN) {
+        if (data.size() - NET_HEADER_LEN < headerPtr->m_size) {
+            return false;
+        }
+        return g_theServer->HandleHandshakePackage(source, std::string_view(&data[NET_HEADER_LEN], headerPtr->m_size));
+    }
+    else if(headerPtr->m_type==eNetworkPackageHeaderType::HEAD_TEXT){    
+        if (data.size() - NET_HEADER_LEN < headerPtr->m_size) {
+            return false;
+        }
+
+        Client* c = g_theServer->GetClientOfPacket(identifier, source);
+        if (c == nullptr) {
+            return false;
+        }
+        c->m_metrics.RecordReceivedPacket((int)data.size());
+
+        NetPacketReader reader(&data[NET_HEADER_LEN], headerPtr->m_size);
+        NetPacketHeader packetHeader;
+        if (!reader.ReadPacketHeader(packetHeader)) {
+            return false;
+        }
+        if (!c->ReceivePacketHeader(packetHeader, receiveTime)) {
+            return true;    //duplicate packet
+        }
+
+        if (packetHeader.m_flags & PACKET_FLAG_COMPRESSED) {
+            if (!DecompressPacketContent(&data[PACKET_PREFIX_LEN], headerPtr->m_size - PACKET_HEADER_LEN, decompressed, PACKET_MAX_CONTENT_LEN)) {
+                g_theConsole->PrintError(Stringf("Corrupt compressed packet from %i", identifier));
+                return false;
+            }
+            reader = NetPacketReader(decompressed.data(), decompressed.size());
+        }
+
+        NetMessageHeader header;
+        std::string_view content;
+        while (reader.ReadMessage(header, content)) {
+            if (header.m_type != eNetMessageHeaderType::MESSAGE_FRAGMENT) {
+                g_theServer->HandleUDPMessageOfIdentifier(header, content, identifier);
+                continue;
+            }
+
+            //completed message is dispatched as if it came whole
+            c = g_theServer->GetClientOfPacket(identifier, source);
+            if (c == nullptr || !c->m_fragments.ReceiveFragment(content, GetCurrentTimeSeconds(), reassembled)) {
+                continue;
+            }
+            NetPacketReader messageReader(reassembled.data(), reassembled.size());
+            NetMessageHeader wholeHeader;
+            std::string_view wholeContent;
+            if (messageReader.ReadMessage(wholeHeader, wholeContent) && wholeHeader.m_type != eNetMessageHeaderType::MESSAGE_FRAGMENT) {
+                g_theServer->HandleUDPMessageOfIdentifier(wholeHeader, wholeContent, identifier);
+            }
+            else {
+                g_theConsole->PrintError(Stringf("Invalid reassembled message from %i", identifier));
+            }
+        }
+        if (reader.HasError()) {
+            g_theConsole->PrintError(Stringf("Truncated message in packet from %i", identifier));
+        }
+        return true;
+    }
+
+    //invalid or unknown header types are not part of the game protocol, dropped
+    m_droppedUnknownPackets++;
+    return false;
 }
 
 //////////////////////////////////////////////////////////////////////////
 void NetworkObserver::EndFrame()
 {
-    if(m_sendTimer.CheckAndReset()){
-        UpdateEntityTransformMessages();
-        UpdateSoundPlayMessages();
-        UpdatePackages();
+    UpdateEntityTransformMessages();
+    UpdateSoundPlayMessages();
+
+    //spread this frame's packets over as long as the last frame took, up to a few ms
+    double now = GetCurrentTimeSeconds();
+    m_pacer.SetWindow(m_lastEndFrameTime > 0.0 ? (float)(now - m_lastEndFrameTime) : 0.f);
+    m_lastEndFrameTime = now;
+
+    g_theServer->SendMessages(m_messages);
+    m_messages.clear();
+    ReleaseSimulatedPackets(NET_SIM_OUTGOING, GetCurrentTimeSeconds());
+    g_theNetIO->SubmitBatch();
+
+    if (m_statsDumpInterval > 0.f && now >= m_nextStatsDumpTime) {
+        DumpConnectionStats(now);
+        m_nextStatsDumpTime = now + m_statsDumpInterval;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void NetworkObserver::SetStatsDump(std::string const& path, float intervalSeconds)
+{
+    m_statsDumpPath = path;
+    m_statsDumpInterval = intervalSeconds;
+    m_nextStatsDumpTime = 0.0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one line per connection, file reopened each dump so it can be read while running
+void NetworkObserver::DumpConnectionStats(double now)
+{
+    std::ofstream file(m_statsDumpPath, std::ios::out | std::ios::app);
+    if (!file) {
+        g_theConsole->PrintError(Stringf("Could not open %s, net stats dump stopped", m_statsDumpPath.c_str()));
+        m_statsDumpInterval = 0.f;
+        return;
+    }
 
-        while(!m_packages.empty()){
-            std::string pack = m_packages.front();
-            g_theServer->SendOneMessage(pack);
-            m_packages.pop();
+    for (Client* c : g_theServer->m_clients) {
+        if (c->m_transport != nullptr) {
+            file << c->m_metrics.MakeJson(c->m_identifier, c->m_connection.GetStats(), now) << '\n';
         }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// bots already running are replaced so every one joins fresh
+void NetworkObserver::StartFirefightBench(float phaseSeconds)
+{
+    m_firefightBench = FirefightBench();
+    m_firefightBench.phase = FIREFIGHT_WARMUP;
+    m_firefightBench.phaseSeconds = phaseSeconds;
+    m_firefightBench.phaseStartTime = GetCurrentTimeSeconds();
+    m_replicateProjectileTransforms = false;
+}
 
-        g_theServer->SendReliableMessages();
+//////////////////////////////////////////////////////////////////////////
+// warmup ends once every bot has its baseline, then one phase per replication mode
+void NetworkObserver::UpdateFirefightBench(double now)
+{
+    FirefightBench& bench = m_firefightBench;
+    if (bench.phase == FIREFIGHT_IDLE) {
+        return;
+    }
+    if (m_loopbackPeers.empty()) {
+        g_theConsole->PrintError("Firefight bench stopped, no bots left");
+        bench.phase = FIREFIGHT_IDLE;
+        m_replicateProjectileTransforms = false;
+        return;
+    }
+
+    if (bench.phase == FIREFIGHT_WARMUP) {
+        for (LoopbackPeer const* peer : m_loopbackPeers) {
+            if (!peer->IsReady() || now - peer->GetStats().readyTime < BOT_JOIN_GRACE_SECONDS) {
+                return;
+            }
+        }
+    }
+    else if (now - bench.phaseStartTime < (double)bench.phaseSeconds) {
+        return;
     }
+    else {
+        int result = bench.phase == FIREFIGHT_TRANSFORMS ? 0 : 1;
+        double seconds = now - bench.phaseStartTime;
+        bench.kbpsPerBot[result] = (double)(GetBotReceivedBytes() - bench.phaseStartBytes) * 8.0 / 1000.0 / seconds / (double)m_loopbackPeers.size();
+        bench.projectileUpdates[result] = (bench.phase == FIREFIGHT_TRANSFORMS ? m_projectileUpdates : m_skippedProjectileUpdates) - bench.phaseStartProjectileUpdates;
+    }
+
+    if (bench.phase == FIREFIGHT_SPAWN_ONLY) {
+        double saved = bench.kbpsPerBot[0] > 0.0 ? (1.0 - bench.kbpsPerBot[1] / bench.kbpsPerBot[0]) * 100.0 : 0.0;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Firefight %i bots, %.0fs per phase, received per bot:", (int)m_loopbackPeers.size(), bench.phaseSeconds));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    projectile transforms: %.1fkbps, %lld projectile transforms sent", bench.kbpsPerBot[0], bench.projectileUpdates[0]));
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("    spawn and delete only: %.1fkbps, %lld projectile transforms skipped, %.1f%% less", bench.kbpsPerBot[1], bench.projectileUpdates[1], saved));
+        bench.phase = FIREFIGHT_IDLE;
+        return;
+    }
+
+    bench.phase = bench.phase == FIREFIGHT_WARMUP ? FIREFIGHT_TRANSFORMS : FIREFIGHT_SPAWN_ONLY;
+    m_replicateProjectileTransforms = bench.phase == FIREFIGHT_TRANSFORMS;
+    bench.phaseStartTime = now;
+    bench.phaseStartBytes = GetBotReceivedBytes();
+    bench.phaseStartProjectileUpdates = m_replicateProjectileTransforms ? m_projectileUpdates : m_skippedProjectileUpdates;
 }
 
 //////////////////////////////////////////////////////////////////////////
-void NetworkObserver::UpdateSendTimer(Clock* clock)
+long long NetworkObserver::GetBotReceivedBytes() const
 {
-    m_sendTimer.SetTimerSeconds(clock,1.f/(double)g_sendRatePerSec);
+    long long bytes = 0;
+    for (LoopbackPeer const* peer : m_loopbackPeers) {
+        bytes += peer->GetStats().receivedBytes;
+    }
+    return bytes;
 }
 
 //////////////////////////////////////////////////////////////////////////
+// server picks ids or names per client, a remote server only sends ids once its tables matched
 void NetworkObserver::UpdateSoundPlayMessages()
 {
+    NetStringTables const& tables = g_theServer->m_stringTables;
     for (size_t i : m_SFXToPlay) {
-        std::string newMsg = MakeSoundPlayMessage(i);
-        AddMessage(newMsg);
+        if (!g_theServer->m_isAuthoritative) {
+            AddMessage(MakeSoundPlayMessage(i, tables.IsNegotiated() ? &tables : nullptr));
+            continue;
+        }
+
+        SharedMessage nameMsg = MakeSharedMessage(MakeSoundPlayMessage(i, nullptr));
+        SharedMessage idMsg = MakeSharedMessage(MakeSoundPlayMessage(i, &tables));
+        for (Client* c : g_theServer->m_clients) {
+            if (c->m_isRemote) {
+                c->QueueMessage(c->HasStringTable() ? idMsg : nameMsg);
+            }
+        }
     }
 
     m_SFXToPlay.clear();
@@ -164,17 +1020,365 @@ void NetworkObserver::UpdateSoundPlayMessages()
 //////////////////////////////////////////////////////////////////////////
 void NetworkObserver::UpdateEntityTransformMessages()
 {
-    for (Entity* e : m_entityTransformChanged) {
-        std::string newPackage = MakeEntityTransformMessage(e);
-        AddMessage(newPackage);
+    //only server replicates transforms, each client picks by own priority
+    if (g_theServer->m_isAuthoritative) {
+        for (Client* c : g_theServer->m_clients) {
+            if (!c->m_isRemote) {
+                continue;
+            }
+            for (Entity* e : m_entityTransformChanged) {
+                //projectiles replicate at spawn and delete only, clients fly them
+                if (e->GetEntityType() == ENTITY_PROJECTILE) {
+                    if (!m_replicateProjectileTransforms) {
+                        m_skippedProjectileUpdates++;
+                        continue;
+                    }
+                    m_projectileUpdates++;
+                }
+                //own pawn goes in player state once predicting
+                if (e == c->m_playerPawn && c->m_hasInputSeq) {
+                    continue;
+                }
+                c->m_priority.MarkDirty(e);
+            }
+        }
     }
 
     m_entityTransformChanged.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////
-void NetworkObserver::UpdatePackages()
+// time decoding a full size packet of transform messages through the receive path parser
+COMMAND(NetParseBench, "time parsing of a full packet of transforms, iterations=1000", eEventFlag::EVENT_CONSOLE)
 {
-    PackUpMessages(m_messages, m_packages);
-    m_messages.clear();
+    int iterations = args.GetValue("iterations", 1000);
+    if (iterations <= 0) {
+        g_theConsole->PrintError("Invalid iterations for NetParseBench");
+        return false;
+    }
+
+    //fill packet the way Client::AppendToPacket does
+    std::string packet(PACKET_HEADER_LEN, '\0');
+    for (int i = 0;; i++) {
+        std::string content = Stringf("%i;%f,%f,%f;%f;%f", i, (float)i * 1.5f, (float)i * -.5f, .5f, 12.f, (float)i);
+        NetMessageHeader header;
+        header.m_type = MESSAGE_ENTITY_TRANSFORM;
+        header.m_size = (unsigned short)content.size();
+        if ((int)(packet.size() + MESSAGE_HEADER_LEN + content.size()) > NET_MAX_DATA_LEN) {
+            break;
+        }
+        packet.append(reinterpret_cast<char const*>(&header), MESSAGE_HEADER_LEN);
+        packet += content;
+    }
+
+    int msgCount = 0;
+    int failCount = 0;
+    double startSeconds = GetCurrentTimeSeconds();
+    for (int i = 0; i < iterations; i++) {
+        NetPacketReader reader(packet.data(), packet.size());
+        NetPacketHeader packetHeader;
+        reader.ReadPacketHeader(packetHeader);
+        NetMessageHeader header;
+        std::string_view content;
+        while (reader.ReadMessage(header, content)) {
+            EntityTransformInfo info;
+            if (DecodeEntityTransformMessage(content, info)) {
+                msgCount++;
+            }
+            else {
+                failCount++;
+            }
+        }
+    }
+    double totalSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i bytes, %i msgs per packet, %i fails", 
+        (int)packet.size(), msgCount / iterations, failCount));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%.3f us per packet, %.1f ns per msg",
+        totalSeconds * 1000000.0 / (double)iterations, totalSeconds * 1000000000.0 / (double)(msgCount > 0 ? msgCount : 1)));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetCompression, "print packet compression ratio and cost, enabled=true|false to toggle", eEventFlag::EVENT_CONSOLE)
+{
+    g_compressPackets = args.GetValue("enabled", g_compressPackets);
+
+    CompressionStats const& stats = GetCompressionStats();
+    double ratio = stats.rawBytes > 0 ? (double)stats.compressedBytes / (double)stats.rawBytes : 1.0;
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("Compression %s: %lld/%lld packets compressed, %lld -> %lld bytes (%.1f%%)",
+        g_compressPackets ? "on" : "off", stats.compressedPackets, stats.consideredPackets, stats.rawBytes, 
+        stats.compressedBytes, ratio * 100.0));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    compress %.3fms total, decompress %.3fms total over %lld packets, %lld corrupt",
+        stats.compressSeconds * 1000.0, stats.decompressSeconds * 1000.0, stats.decompressedPackets, stats.failedPackets));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetCaptureTraffic, "capture content of next sent packets for NetCompressionBench, packets=256", eEventFlag::EVENT_CONSOLE)
+{
+    int packets = args.GetValue("packets", 256);
+    StartPacketCapture(packets);
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("Capturing next %i sent packets", packets < MAX_CAPTURED_PACKETS ? packets : MAX_CAPTURED_PACKETS));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// round trip captured packets through the codec, ratio counts all packets
+COMMAND(NetCompressionBench, "time compression of captured traffic, iterations=100", eEventFlag::EVENT_CONSOLE)
+{
+    int iterations = args.GetValue("iterations", 100);
+    std::vector<std::string> const& packets = GetCapturedPackets();
+    if (iterations <= 0 || packets.empty()) {
+        g_theConsole->PrintError("No captured traffic or invalid iterations, run NetCaptureTraffic first");
+        return false;
+    }
+
+    std::string compressed;
+    std::string restored;
+    long long rawBytes = 0;
+    long long compressedBytes = 0;
+    int shrunkPackets = 0;
+    int mismatchPackets = 0;
+    for (std::string const& packet : packets) {
+        CompressBytes(packet.data(), packet.size(), compressed);
+        DecompressBytes(compressed.data(), compressed.size(), restored, packet.size());
+        mismatchPackets += restored == packet ? 0 : 1;
+        shrunkPackets += compressed.size() < packet.size() ? 1 : 0;
+        rawBytes += (long long)packet.size();
+        compressedBytes += (long long)(compressed.size() < packet.size() ? compressed.size() : packet.size());
+    }
+
+    double startSeconds = GetCurrentTimeSeconds();
+    for (int i = 0; i < iterations; i++) {
+        for (std::string const& packet : packets) {
+            CompressBytes(packet.data(), packet.size(), compressed);
+        }
+    }
+    double compressSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+    std::vector<std::string> compressedPackets;
+    for (std::string const& packet : packets) {
+        CompressBytes(packet.data(), packet.size(), compressed);
+        compressedPackets.push_back(compressed);
+    }
+    startSeconds = GetCurrentTimeSeconds();
+    for (int i = 0; i < iterations; i++) {
+        for (std::string const& packet : compressedPackets) {
+            DecompressBytes(packet.data(), packet.size(), restored, NET_MAX_DATA_LEN);
+        }
+    }
+    double decompressSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+    double totalMB = (double)rawBytes * (double)iterations / (1024.0 * 1024.0);
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%i packets, %lld -> %lld bytes (%.1f%%), %i shrunk, %i round trip mismatches",
+        (int)packets.size(), rawBytes, compressedBytes, rawBytes > 0 ? (double)compressedBytes * 100.0 / (double)rawBytes : 100.0,
+        shrunkPackets, mismatchPackets));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("compress %.2f us/packet (%.1f MB/s), decompress %.2f us/packet (%.1f MB/s)",
+        compressSeconds * 1000000.0 / ((double)iterations * packets.size()), totalMB / (compressSeconds > 0.0 ? compressSeconds : 1.0),
+        decompressSeconds * 1000000.0 / ((double)iterations * packets.size()), totalMB / (decompressSeconds > 0.0 ? decompressSeconds : 1.0)));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// one notify per packet against one per frame, through a private io thread
+// every packet is still its own socket send, only thread wakes are batched
+static void RunNetIOBench(std::vector<NetTransport*> const& transports, std::string const& packet, int ticks, bool isBatched)
+{
+    NetIOThread io;
+    io.Startup();
+    double startSeconds = GetCurrentTimeSeconds();
+    for (int tick = 0; tick < ticks; tick++) {
+        for (NetTransport* transport : transports) {
+            io.QueuePacket(transport, packet);
+            if (!isBatched) {
+                io.SubmitBatch();
+            }
+        }
+        if (isBatched) {
+            io.SubmitBatch();
+        }
+        io.Flush();
+    }
+    double seconds = GetCurrentTimeSeconds() - startSeconds;
+    io.Shutdown();
+
+    NetIOStats stats = io.GetStats();
+    long long packets = stats.sentPackets;
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("%s: per tick %.1f socket sends, %.1f notifies, %.1f io thread wakeups, %.0f packets/s, max batch %i",
+        isBatched ? "wake per frame" : "wake per packet", (double)packets / (double)ticks, (double)stats.wakeCalls / (double)ticks,
+        (double)stats.threadWakeups / (double)ticks, seconds > 0.0 ? (double)packets / seconds : 0.0, stats.maxBatchSize));
+}
+
+//////////////////////////////////////////////////////////////////////////
+COMMAND(NetIOBench, "send a snapshot sized packet to each simulated client per tick, clients=64 ticks=200 memory=false", eEventFlag::EVENT_CONSOLE)
+{
+    int clients = args.GetValue("clients", 64);
+    int ticks = args.GetValue("ticks", 200);
+    bool isInMemory = args.GetValue("memory", false);
+    if (clients <= 0 || clients > NET_IO_QUEUE_SIZE || ticks <= 0) {
+        g_theConsole->PrintError(Stringf("Invalid NetIOBench clients (1-%i) or ticks", NET_IO_QUEUE_SIZE));
+        return false;
+    }
+
+    //udp sockets talk to themselves over 127.0.0.1, receiver drops them as their key has no route
+    //in memory ones go to loopback ends nobody reads, leaving only the io thread cost
+    constexpr int BENCH_FIRST_PORT = 47001;
+    std::vector<NetTransport*> transports;
+    std::vector<NetTransport*> unreadEnds;
+    for (int i = 0; i < clients; i++) {
+        if (isInMemory) {
+            LoopbackTransport* sendEnd = nullptr;
+            LoopbackTransport* unreadEnd = nullptr;
+            LoopbackTransport::CreatePair(sendEnd, unreadEnd);
+            transports.push_back(sendEnd);
+            unreadEnds.push_back(unreadEnd);
+        }
+        else {
+            transports.push_back(new UDPTransport(g_theNetwork->CreateUDPSocket("127.0.0.1", BENCH_FIRST_PORT + i, BENCH_FIRST_PORT + i)));
+        }
+    }
+    std::string packet = MakeTextPackage(std::string(PACKET_MAX_CONTENT_LEN / 2, '\0'), false);
+    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&packet[0]);
+    headerPtr->m_key = 0;
+
+    RunNetIOBench(transports, packet, ticks, false);
+    RunNetIOBench(transports, packet, ticks, true);
+
+    for (NetTransport* transport : transports) {
+        delete transport;
+    }
+    for (NetTransport* transport : unreadEnds) {
+        delete transport;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// client and server pawn offline, inputs up and player states down through a seeded simulator,
+// same predictor, jitter buffer and messages as the live path so only collision is left out
+COMMAND(NetPredictionBench, "prediction under simulated latency, latency=100 jitter=10 loss=5 seed=1 seconds=20 fps=60 tickrate=60 sendrate=20", eEventFlag::EVENT_CONSOLE)
+{
+    NetSimSettings link;
+    link.latencyMs = args.GetValue("latency", 100.f) * .5f;     //one way
+    link.jitterMs = args.GetValue("jitter", 10.f) * .5f;
+    link.lossPercent = args.GetValue("loss", 5.f);
+    unsigned int seed = (unsigned int)args.GetValue("seed", 1);
+    float seconds = args.GetValue("seconds", 20.f);
+    float fps = args.GetValue("fps", 60.f);
+    float tickRate = args.GetValue("tickrate", 60.f);
+    float sendRate = args.GetValue("sendrate", 20.f);
+    EntityDef const* pawnDef = EntityDef::GetEntityDefinitionFromName("Marine");
+    if (seconds <= 0.f || fps <= 0.f || tickRate <= 0.f || sendRate <= 0.f || pawnDef == nullptr) {
+        g_theConsole->PrintError("Invalid NetPredictionBench seconds, fps, tickrate or sendrate, or no Marine def");
+        return false;
+    }
+
+    NetSimulator sim;
+    sim.SetSeed(seed);
+    sim.SetSettings(NET_SIM_OUTGOING, link);    //client to server
+    sim.SetSettings(NET_SIM_INCOMING, link);    //server to client
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> roll(-1.f, 1.f);
+
+    Actor clientPawn(nullptr, pawnDef);
+    Actor serverPawn(nullptr, pawnDef);
+    InputPredictor predictor;
+    InputJitterBuffer inputBuffer;
+    std::vector<InputInfo> redundantInputs;
+    std::vector<InputInfo> messageInputs;
+    std::vector<InputInfo> tickInputs;
+    SimulatedPacket packet;
+    InputInfo input;
+    unsigned short lastServerSeq = 0;
+    bool hasServerSeq = false;
+    double nextInputChange = 0.0;
+    double nextFrame = 0.0;
+    double nextTick = 0.0;
+    double nextClientSend = 0.0;
+    double nextServerSend = .5 / (double)sendRate;
+    float correctionDistSum = 0.f;
+    int prevCorrections = 0;
+
+    for (double now = 0.0; now < (double)seconds;) {
+        //client frame: sample, predict, send on own interval, reconcile arrived states
+        if (nextFrame <= nextTick) {
+            now = nextFrame;
+            nextFrame += 1.0 / (double)fps;
+            while (sim.PopDuePacket(NET_SIM_INCOMING, now, packet)) {
+                PlayerStateInfo state;
+                if (ParsePlayerStateMessage(std::string_view(packet.data).substr(MESSAGE_HEADER_LEN), state)) {
+                    predictor.Reconcile(state, &clientPawn, g_theGame);
+                    PredictionStats const& stats = predictor.GetStats();
+                    if (stats.corrections > prevCorrections) {
+                        correctionDistSum += stats.lastCorrectionDist;
+                        prevCorrections = stats.corrections;
+                    }
+                }
+            }
+
+            if (now >= nextInputChange) {
+                input.playerMove = Vec2(roll(rng), roll(rng));
+                input.mouseMove = Vec2(roll(rng) * .2f, 0.f);
+                nextInputChange = now + 1.0 + (double)roll(rng) * .5;
+            }
+            input.isFiring = roll(rng) > .96f;
+            input.seq = predictor.GetNextSeq();
+            input.deltaSeconds = 1.f / fps;
+            g_theGame->UpdatePlayerForInput(&clientPawn, input, input.deltaSeconds);
+            predictor.RecordInput(input, &clientPawn);
+
+            if (now >= nextClientSend) {
+                nextClientSend += 1.0 / (double)sendRate;
+                predictor.GetRedundantInputs(redundantInputs, MAX_REDUNDANT_INPUTS);
+                predictor.RecordSend();
+                std::string upstream;
+                for (size_t first = 0; first < redundantInputs.size(); first += MAX_INPUTS_PER_MESSAGE) {
+                    size_t last = first + MAX_INPUTS_PER_MESSAGE < redundantInputs.size() ? first + MAX_INPUTS_PER_MESSAGE : redundantInputs.size();
+                    messageInputs.assign(redundantInputs.begin() + first, redundantInputs.begin() + last);
+                    upstream += MakePlayerInputMessage(messageInputs);
+                }
+                sim.Submit(NET_SIM_OUTGOING, nullptr, upstream, now);
+            }
+            continue;
+        }
+
+        //server tick: buffer arrived inputs, play back this tick's worth, echo state on own interval
+        now = nextTick;
+        nextTick += 1.0 / (double)tickRate;
+        while (sim.PopDuePacket(NET_SIM_OUTGOING, now, packet)) {
+            NetPacketReader reader(packet.data.data(), packet.data.size());
+            NetMessageHeader header;
+            std::string_view content;
+            while (reader.ReadMessage(header, content)) {
+                if (ParsePlayerInputMessage(content, tickInputs)) {
+                    for (InputInfo const& received : tickInputs) {
+                        inputBuffer.Insert(received);
+                    }
+                }
+            }
+        }
+        inputBuffer.PopTickInputs(tickInputs, 1.f / tickRate);
+        for (InputInfo const& played : tickInputs) {
+            g_theGame->UpdatePlayerForInput(&serverPawn, played, played.deltaSeconds);
+            lastServerSeq = played.seq;
+            hasServerSeq = true;
+        }
+        if (hasServerSeq && now >= nextServerSend) {
+            nextServerSend += 1.0 / (double)sendRate;
+            sim.Submit(NET_SIM_INCOMING, nullptr, MakePlayerStateMessage(&serverPawn, lastServerSeq), now);
+        }
+    }
+
+    PredictionStats const& stats = predictor.GetStats();
+    InputBufferStats const& bufferStats = inputBuffer.GetStats();
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("rtt %.0fms +-%.0f, loss %.1f%% each way, seed %u, %.0fs at %.0ffps, tick %.0fHz, send %.0fHz",
+        link.latencyMs * 2.f, link.jitterMs * 2.f, link.lossPercent, seed, seconds, fps, tickRate, sendRate));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    predicted %i, corrections %i (%.2f/s), avg %.4f, max %.4f, replayed %i",
+        stats.predictedInputs, stats.corrections, (float)stats.corrections / seconds,
+        stats.corrections > 0 ? correctionDistSum / (float)stats.corrections : 0.f, stats.maxCorrectionDist, stats.replayedInputs));
+    g_theConsole->PrintString(Rgba8::WHITE, Stringf("    inputs lost %i, starved ticks %i, packets lost up %lld down %lld, final drift %.4f",
+        bufferStats.lostInputs, bufferStats.starvedTicks, sim.GetStats(NET_SIM_OUTGOING).lostPackets, sim.GetStats(NET_SIM_INCOMING).lostPackets,
+        (clientPawn.GetEntityPosition2D() - serverPawn.GetEntityPosition2D()).GetLength()));
+    return true;
 }
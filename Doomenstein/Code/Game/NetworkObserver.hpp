@@ -2,39 +2,99 @@
 
 #include <vector>
 #include <string>
-#include <queue>
-#include "Engine/Core/Timer.hpp"
+#include <unordered_map>
+#include "Game/NetworkMessage.hpp"
+#include "Game/NetSimulator.hpp"
+#include "Game/NetPacer.hpp"
 
 class Entity;
+class NetTransport;
+class LoopbackPeer;
 
-void PackUpMessages(std::vector<std::string> const& msgs, std::queue<std::string>& packages, bool reliable=false);
+//////////////////////////////////////////////////////////////////////////
+// NetFirefightBench, same bots measured with projectile transforms then without
+enum eFirefightBenchPhase : int
+{
+    FIREFIGHT_IDLE = 0,
+    FIREFIGHT_WARMUP,           //bots joining and streaming baseline
+    FIREFIGHT_TRANSFORMS,       //projectiles get transforms in flight, as before spawn only
+    FIREFIGHT_SPAWN_ONLY,
+};
+
+struct FirefightBench
+{
+    eFirefightBenchPhase phase = FIREFIGHT_IDLE;
+    float phaseSeconds = 0.f;
+    double phaseStartTime = 0.0;
+    long long phaseStartBytes = 0;
+    long long phaseStartProjectileUpdates = 0;
+    double kbpsPerBot[2] = {};
+    long long projectileUpdates[2] = {};
+};
 
 //////////////////////////////////////////////////////////////////////////
 class NetworkObserver
 {
 public:
     NetworkObserver();
+    ~NetworkObserver();
 
     void AddEntityTransformUpdate(Entity* entity);
+    void RemoveEntityTransformUpdate(int entityIdx);
     void AddSoundPlay(size_t id);
     void AddMessage(std::string const& package);
 
     void Restart();
-    void EndFrame();  //send messages; clear
+    void BeginFrame();  //pump loopback peers and polled transports
+    void EndFrame();  //hand messages to clients, each sends at own rate; clear
 
-    void UpdateSendTimer(Clock* clock);
+    void SendPacket(NetTransport* transport, std::string const& packet, float bytesPerSec = 0.f, bool isTimeCritical = false);
+    double SchedulePacket(NetTransport* transport, int bytes, float bytesPerSec, bool isTimeCritical);   //when it will leave
+    void QueuePacket(NetTransport* transport, std::string const& packet, double releaseTime);
+    bool ReceivePacket(NetTransport* source, std::string& data, double receiveTime);
+    void ForgetTransport(NetTransport* transport);
+    NetSimulator& GetSimulator() {return m_simulator;}
+    NetPacer& GetPacer() {return m_pacer;}
+    void SetLoopbackPeerCount(int count);
+    void ConnectUDPPeers(std::string const& serverIP, int serverPort, std::string const& replyIP, int count);
+    void SetStatsDump(std::string const& path, float intervalSeconds);    //zero interval stops
+    void StartFirefightBench(float phaseSeconds);
+    std::vector<LoopbackPeer*> const& GetLoopbackPeers() const {return m_loopbackPeers;}
+
+    long long GetSkippedProjectileUpdates() const {return m_skippedProjectileUpdates;}
+    long long GetDroppedUnknownPackets() const {return m_droppedUnknownPackets;}
+    long long GetProjectileUpdates() const {return m_projectileUpdates;}
 
 private:
+    bool DeliverPacket(NetTransport* source, std::string& data, double receiveTime);
+    void ReleaseSimulatedPackets(eNetSimDirection direction, double now);
     void UpdateSoundPlayMessages();
     void UpdateEntityTransformMessages();
-    void UpdatePackages();
+    void DumpConnectionStats(double now);
+    void UpdateFirefightBench(double now);
+    long long GetBotReceivedBytes() const;
 
 private:
     std::vector<size_t> m_SFXToPlay;
     std::vector<Entity*> m_entityTransformChanged;
 
-    std::vector<std::string> m_messages;
-    std::queue<std::string> m_packages;
+    std::vector<SharedMessage> m_messages;
+    long long m_skippedProjectileUpdates = 0;   //per client transforms not sent for projectiles
+    long long m_droppedUnknownPackets = 0;      //header type not handled by the game
+    long long m_projectileUpdates = 0;          //per client projectile transforms marked, only while benched
+    bool m_replicateProjectileTransforms = false;
+    FirefightBench m_firefightBench;
+
+    std::vector<LoopbackPeer*> m_loopbackPeers;     //protocol clients without a world, loopback or udp
+    std::unordered_map<NetTransport*, LoopbackPeer*> m_peerOfUDPTransport;
+    std::string m_receiveBuffer;
+
+    NetSimulator m_simulator;   //impairs traffic between transports and game when enabled
+    SimulatedPacket m_simPacket;
+    NetPacer m_pacer;           //spreads sends across the frame for the io thread
+    double m_lastEndFrameTime = 0.0;
 
-    Timer m_sendTimer;
+    std::string m_statsDumpPath;    //json lines appended per connection
+    float m_statsDumpInterval = 0.f;
+    double m_nextStatsDumpTime = 0.0;
 };
\ No newline at end of file
@@ -39,7 +39,6 @@ void PlayerClient::BeginFrame()
 
     if (!g_theConsole->IsOpen() && m_playerPawn) {
         m_server->m_theGame->UpdateKeyboardStates(m_input);
-        m_shot = m_input.isFiring || m_shot;
     }
 }
 
@@ -63,6 +62,9 @@ void PlayerClient::Update()
     if (g_theInput->WasKeyJustPressed(KEY_F1)) {
         g_debugDrawing = !g_debugDrawing;
     }
+    if (g_theInput->WasKeyJustPressed(KEY_F2)) {
+        g_showNetStats = !g_showNetStats;
+    }
 
     float deltaChange = (float)g_theGame->GetClock()->GetLastDeltaSeconds() * SEND_RATE_CHANGE_RATE;
     if (g_theInput->IsKeyDown(KEY_MINUS)) {
@@ -71,7 +73,7 @@ void PlayerClient::Update()
     if (g_theInput->IsKeyDown(KEY_PLUS)) {
         g_sendRatePerSec += deltaChange;
     }
-    g_sendRatePerSec = Clamp(g_sendRatePerSec,10.f,30.f);
+    g_sendRatePerSec = Clamp(g_sendRatePerSec,MIN_SEND_RATE_PER_SEC,MAX_SEND_RATE_PER_SEC);
 }
 
 //////////////////////////////////////////////////////////////////////////
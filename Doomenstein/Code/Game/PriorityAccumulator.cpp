@@ -0,0 +1,114 @@
+#include "Game/PriorityAccumulator.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/Entity.hpp"
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+void PriorityAccumulator::MarkDirty(Entity* entity)
+{
+    PriorityEntry& entry = m_entries[entity->GetIndex()];
+    entry.entity = entity;
+    entry.isDirty = true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void PriorityAccumulator::RemoveEntity(int entityIdx)
+{
+    m_entries.erase(entityIdx);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void PriorityAccumulator::Clear()
+{
+    m_entries.clear();
+    m_sorted.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void PriorityAccumulator::Accumulate(Entity const* viewer, float deltaSeconds)
+{
+    for (auto& it : m_entries) {
+        PriorityEntry& entry = it.second;
+        entry.secondsSinceSent += deltaSeconds;
+        if (entry.isDirty) {
+            entry.priority += GetPriorityWeight(entry.entity, viewer) * deltaSeconds;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void PriorityAccumulator::GatherMessages(std::vector<std::string>& msgs, int byteBudget)
+{
+    m_sorted.clear();
+    for (auto& it : m_entries) {
+        PriorityEntry& entry = it.second;
+        if (entry.isDirty && entry.entity != nullptr && !entry.entity->IsGarbage()) {
+            m_sorted.push_back(&entry);
+        }
+    }
+    std::sort(m_sorted.begin(), m_sorted.end(), [](PriorityEntry const* a, PriorityEntry const* b) {
+        return a->priority > b->priority;
+    });
+
+    int bytesUsed = 0;
+    m_stats.starvedEntities = 0;
+    for (PriorityEntry* entry : m_sorted) {
+        std::string msg = MakeEntityTransformMessage(entry->entity);
+        int msgSize = (int)msg.size();
+        if (bytesUsed + msgSize > byteBudget) {
+            //keep accumulating for next send
+            entry->sendsWaited++;
+            m_stats.deferredUpdates++;
+            m_stats.starvedEntities++;
+            m_stats.maxSendsWaited = std::max(m_stats.maxSendsWaited, entry->sendsWaited);
+            m_stats.maxSecondsWaited = std::max(m_stats.maxSecondsWaited, entry->secondsSinceSent);
+            continue;
+        }
+
+        bytesUsed += msgSize;
+        msgs.push_back(msg);
+        entry->priority = 0.f;
+        entry->secondsSinceSent = 0.f;
+        entry->sendsWaited = 0;
+        entry->isDirty = false;
+        m_stats.sentUpdates++;
+    }
+
+    m_stats.lastBytesUsed = bytesUsed;
+    m_stats.sentBytes += bytesUsed;
+}
+
+//////////////////////////////////////////////////////////////////////////
+size_t PriorityAccumulator::GetDirtyCount() const
+{
+    size_t count = 0;
+    for (auto const& it : m_entries) {
+        if (it.second.isDirty) {
+            count++;
+        }
+    }
+    return count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+float PriorityAccumulator::GetPriorityWeight(Entity const* entity, Entity const* viewer) const
+{
+    float weight = 1.f;
+    switch (entity->GetEntityType()) {
+    case ENTITY_ACTOR:      weight = 2.f;   break;
+    case ENTITY_PROJECTILE: weight = 1.5f;  break;
+    default:                weight = .5f;   break;
+    }
+
+    if (viewer == nullptr || viewer == entity) {
+        return weight * 2.f;
+    }
+
+    if (viewer->GetMap() != entity->GetMap()) {
+        return weight * PRIORITY_OTHER_MAP_SCALE;
+    }
+
+    float dist = (entity->GetEntityPosition2D() - viewer->GetEntityPosition2D()).GetLength();
+    return weight / (1.f + dist / PRIORITY_DISTANCE_FALLOFF);
+}
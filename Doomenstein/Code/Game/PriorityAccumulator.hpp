@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class Entity;
+
+constexpr float PRIORITY_DISTANCE_FALLOFF = 8.f;
+constexpr float PRIORITY_OTHER_MAP_SCALE = .1f;
+
+//////////////////////////////////////////////////////////////////////////
+struct PriorityEntry
+{
+    Entity* entity = nullptr;
+    float priority = 0.f;
+    float secondsSinceSent = 0.f;
+    int sendsWaited = 0;
+    bool isDirty = false;
+};
+
+//////////////////////////////////////////////////////////////////////////
+struct PriorityStats
+{
+    int sentUpdates = 0;        //total transform updates sent
+    int deferredUpdates = 0;    //total times a dirty entity missed a send
+    int starvedEntities = 0;    //entities still waiting after last send
+    int maxSendsWaited = 0;     //longest wait of any entity, in sends
+    float maxSecondsWaited = 0.f;
+    int lastBytesUsed = 0;
+    long long sentBytes = 0;    //total transform bytes sent
+};
+
+// per client transform priority, only top updates within byte budget are sent
+class PriorityAccumulator
+{
+public:
+    void MarkDirty(Entity* entity);
+    void RemoveEntity(int entityIdx);
+    void Clear();
+
+    void Accumulate(Entity const* viewer, float deltaSeconds);
+    void GatherMessages(std::vector<std::string>& msgs, int byteBudget);
+
+    PriorityStats const& GetStats() const {return m_stats;}
+    size_t GetDirtyCount() const;
+
+private:
+    float GetPriorityWeight(Entity const* entity, Entity const* viewer) const;
+
+private:
+    std::unordered_map<int, PriorityEntry> m_entries;
+    std::vector<PriorityEntry*> m_sorted;
+    PriorityStats m_stats;
+};
\ No newline at end of file
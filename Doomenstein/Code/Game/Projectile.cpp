@@ -15,6 +15,12 @@ Projectile::Projectile(Map* map, EntityDef const* definition)
 void Projectile::Update()
 {
     float deltaSeconds = (float)g_theGame->GetClock()->GetLastDeltaSeconds();
+    Advance(deltaSeconds);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void Projectile::Advance(float deltaSeconds)
+{
     Vec3 deltaMove = m_forward*deltaSeconds*m_entityDef->m_speed;
     Translate(Vec2(deltaMove.x,deltaMove.y));
     m_height += deltaMove.z;
@@ -8,6 +8,7 @@ public:
     Projectile(Map* map, EntityDef const* definition);
 
     void Update() override;
+    void Advance(float deltaSeconds);
     void Render(Entity* playerPawn) const override;
 
     FloatRange GetEntityHeightRange() const override;
@@ -0,0 +1,198 @@
+#include "Game/ReliableMessageStore.hpp"
+#include "Game/MessageFragmenter.hpp"
+
+#include <iterator>
+
+//////////////////////////////////////////////////////////////////////////
+// supersede replaces older message of same key in place, otherwise keep the older one
+void ReliableMessageStore::Insert(eNetMessageHeaderType type, int entityIdx, SharedMessage const& msg, unsigned short id, bool supersede)
+{
+    unsigned long long key = MakeKey(type, entityIdx);
+    auto foundGroup = m_groupByKey.find(key);
+    if (foundGroup != m_groupByKey.end()) {
+        if (!supersede) {
+            return;
+        }
+        RemoveFragmentGroup(foundGroup->second);
+    }
+
+    auto found = m_byKey.find(key);
+    if (found != m_byKey.end()) {
+        if (!supersede) {
+            return;
+        }
+
+        std::list<ReliableMessage>::iterator it = found->second;
+        m_byId.erase(it->id);
+        it->id = id;
+        it->msg = msg;
+        it->sendCount = 0;
+        m_byId[id] = it;
+        return;
+    }
+
+    ReliableMessage newMsg;
+    newMsg.id = id;
+    newMsg.type = type;
+    newMsg.entityIdx = entityIdx;
+    newMsg.msg = msg;
+    m_messages.push_back(newMsg);
+
+    std::list<ReliableMessage>::iterator it = std::prev(m_messages.end());
+    m_byKey[key] = it;
+    m_byId[id] = it;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// fragments of one oversized message, keyed like the whole message for supersede and contains
+void ReliableMessageStore::InsertFragments(eNetMessageHeaderType type, int entityIdx, unsigned short group, std::vector<std::string>& fragments,
+    std::vector<unsigned short> const& ids, bool supersede)
+{
+    unsigned long long key = MakeKey(type, entityIdx);
+    if (Contains(type, entityIdx)) {
+        if (!supersede) {
+            return;
+        }
+        Remove(key);
+    }
+
+    ReliableFragmentGroup& newGroup = m_fragmentGroups[group];
+    newGroup = ReliableFragmentGroup();
+    newGroup.key = key;
+    for (size_t i = 0; i < fragments.size(); i++) {
+        ReliableMessage newMsg;
+        newMsg.id = ids[i];
+        newMsg.type = MESSAGE_FRAGMENT;
+        newMsg.entityIdx = ((int)group << 8) | (int)i;
+        newMsg.msg = MakeSharedMessage(std::move(fragments[i]));
+        newMsg.fragmentGroup = group;
+        m_messages.push_back(newMsg);
+
+        std::list<ReliableMessage>::iterator it = std::prev(m_messages.end());
+        m_byId[ids[i]] = it;
+        newGroup.fragments.push_back(it);
+    }
+    m_groupByKey[key] = group;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool ReliableMessageStore::Contains(eNetMessageHeaderType type, int entityIdx) const
+{
+    unsigned long long key = MakeKey(type, entityIdx);
+    return m_byKey.find(key) != m_byKey.end() || m_groupByKey.find(key) != m_groupByKey.end();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool ReliableMessageStore::Acknowledge(unsigned short id)
+{
+    auto found = m_byId.find(id);
+    if (found == m_byId.end()) {
+        return false;
+    }
+
+    std::list<ReliableMessage>::iterator it = found->second;
+    if (it->fragmentGroup >= 0) {
+        if (it->isAcked) {
+            return true;
+        }
+        it->isAcked = true;
+        ReliableFragmentGroup& group = m_fragmentGroups[(unsigned short)it->fragmentGroup];
+        group.ackedCount++;
+        if (group.ackedCount == (int)group.fragments.size()) {
+            RemoveFragmentGroup((unsigned short)it->fragmentGroup);
+        }
+        return true;
+    }
+
+    m_byKey.erase(MakeKey(it->type, it->entityIdx));
+    m_byId.erase(found);
+    m_messages.erase(it);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ReliableMessageStore::MarkSent(unsigned short id, double now)
+{
+    auto found = m_byId.find(id);
+    if (found == m_byId.end()) {
+        return;
+    }
+    found->second->lastSendTime = now;
+    found->second->sendCount++;
+    found->second->isGroupRepeat = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// acked fragments go out again once per reassembly timeout until their group completes
+void ReliableMessageStore::UpdateFragmentResends(double now)
+{
+    for (auto& it : m_fragmentGroups) {
+        ReliableFragmentGroup& group = it.second;
+        if (group.resendAllTime <= 0.0) {
+            group.resendAllTime = now + FRAGMENT_TIMEOUT_SECONDS;
+            continue;
+        }
+        if (now < group.resendAllTime) {
+            continue;
+        }
+
+        for (std::list<ReliableMessage>::iterator fragment : group.fragments) {
+            fragment->isGroupRepeat = fragment->isAcked;
+            fragment->isAcked = false;
+        }
+        group.ackedCount = 0;
+        group.resendAllTime = now + FRAGMENT_TIMEOUT_SECONDS;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ReliableMessageStore::Clear()
+{
+    m_messages.clear();
+    m_byKey.clear();
+    m_byId.clear();
+    m_fragmentGroups.clear();
+    m_groupByKey.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////
+unsigned long long ReliableMessageStore::MakeKey(eNetMessageHeaderType type, int entityIdx)
+{
+    return ((unsigned long long)type << 32) | (unsigned long long)(unsigned int)entityIdx;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// whole message or its fragment group
+void ReliableMessageStore::Remove(unsigned long long key)
+{
+    auto foundGroup = m_groupByKey.find(key);
+    if (foundGroup != m_groupByKey.end()) {
+        RemoveFragmentGroup(foundGroup->second);
+        return;
+    }
+
+    auto found = m_byKey.find(key);
+    if (found == m_byKey.end()) {
+        return;
+    }
+    std::list<ReliableMessage>::iterator it = found->second;
+    m_byId.erase(it->id);
+    m_byKey.erase(found);
+    m_messages.erase(it);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void ReliableMessageStore::RemoveFragmentGroup(unsigned short group)
+{
+    auto found = m_fragmentGroups.find(group);
+    if (found == m_fragmentGroups.end()) {
+        return;
+    }
+
+    for (std::list<ReliableMessage>::iterator fragment : found->second.fragments) {
+        m_byId.erase(fragment->id);
+        m_messages.erase(fragment);
+    }
+    m_groupByKey.erase(found->second.key);
+    m_fragmentGroups.erase(found);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Game/NetworkMessage.hpp"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+struct ReliableMessage
+{
+    unsigned short id = 0;
+    eNetMessageHeaderType type = MESSAGE_INVALID;
+    int entityIdx = -1;
+    SharedMessage msg;  //payload shared across clients, never copied per client
+    int sendCount = 0;  //more than one means sent again
+    double lastSendTime = 0.0;
+    int fragmentGroup = -1;     //part of an oversized message
+    bool isAcked = false;       //fragments only, kept until the whole group is acked
+    bool isGroupRepeat = false; //acked fragment due again with its group, no loss behind it
+};
+
+//////////////////////////////////////////////////////////////////////////
+// receiver may time out or evict a partly received group, so fragments are
+// kept until all are acked and every one goes out again now and then
+struct ReliableFragmentGroup
+{
+    unsigned long long key = 0;     //of the whole message
+    int ackedCount = 0;
+    double resendAllTime = 0.0;     //set on first send
+    std::vector<std::list<ReliableMessage>::iterator> fragments;
+};
+
+// reliable messages keyed by (type, entity), O(1) supersede and ack, keeps send order
+class ReliableMessageStore
+{
+public:
+    void Insert(eNetMessageHeaderType type, int entityIdx, SharedMessage const& msg, unsigned short id, bool supersede);
+    void InsertFragments(eNetMessageHeaderType type, int entityIdx, unsigned short group, std::vector<std::string>& fragments,
+        std::vector<unsigned short> const& ids, bool supersede);
+    bool Contains(eNetMessageHeaderType type, int entityIdx) const;
+    bool Acknowledge(unsigned short id);
+    void MarkSent(unsigned short id, double now);
+    void UpdateFragmentResends(double now);
+    void Clear();
+
+    size_t GetSize() const {return m_messages.size();}
+    std::list<ReliableMessage> const& GetMessages() const {return m_messages;}
+
+private:
+    static unsigned long long MakeKey(eNetMessageHeaderType type, int entityIdx);
+    void Remove(unsigned long long key);
+    void RemoveFragmentGroup(unsigned short group);
+
+private:
+    std::list<ReliableMessage> m_messages;
+    std::unordered_map<unsigned long long, std::list<ReliableMessage>::iterator> m_byKey;
+    std::unordered_map<unsigned short, std::list<ReliableMessage>::iterator> m_byId;
+    std::unordered_map<unsigned short, ReliableFragmentGroup> m_fragmentGroups;
+    std::unordered_map<unsigned long long, unsigned short> m_groupByKey;
+};
\ No newline at end of file
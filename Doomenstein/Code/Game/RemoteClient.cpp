@@ -2,7 +2,8 @@
 #include "Game/Server.hpp"
 #include "Game/NetworkMessage.hpp"
 #include "Game/NetworkObserver.hpp"
-#include "Engine/Network/UDPSocket.hpp"
+#include "Game/NetIOThread.hpp"
+#include "Game/NetTransport.hpp"
 
 //////////////////////////////////////////////////////////////////////////
 RemoteClient::RemoteClient()
@@ -20,8 +21,8 @@ void RemoteClient::Startup(Entity* playerPawn, Server* server)
 //////////////////////////////////////////////////////////////////////////
 void RemoteClient::Shutdown()
 {
-    if(m_udpSocket && m_udpSocket->IsValid()){
-        m_udpSocket->SendUDPMessage(MakeQuitPackage());
+    if(m_transport && m_transport->IsValid()){
+        g_theNetIO->QueuePacket(m_transport, MakeQuitPackage());
     }
 
     Client::Shutdown();
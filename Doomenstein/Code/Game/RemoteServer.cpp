@@ -5,13 +5,18 @@
 #include "Game/MultiplayerGame.hpp"
 #include "Game/NetworkMessage.hpp"
 #include "Game/NetworkObserver.hpp"
+#include "Game/NetTransport.hpp"
+#include "Game/NetIOThread.hpp"
+#include "Game/GameCommon.hpp"
 #include "Engine/Network/Network.hpp"
-#include "Engine/Network/TCPClient.hpp"
 #include "Engine/Network/UDPSocket.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
 
 //////////////////////////////////////////////////////////////////////////
 RemoteServer::RemoteServer()
@@ -20,19 +25,35 @@ RemoteServer::RemoteServer()
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::SetUpTCPClient(std::string const& serverIP, int port)
+// server learns where to reply from the request, the engine socket can't tell it
+void RemoteServer::Connect(std::string const& serverIP, int serverPort, std::string const& replyIP)
 {
     m_serverIP = serverIP;
-    m_tcpClient = g_theNetwork->CreateTCPClient(serverIP, (unsigned short)port, NET_NON_BLOCKING);
+    m_serverPort = serverPort;
+    m_replyIP = replyIP;
+    m_replyPort = RollRandomUnusedPort();
+    m_handshakeTransport = new UDPTransport(g_theNetwork->CreateUDPSocket(serverIP, serverPort, m_replyPort));
+    if (!m_handshakeTransport->IsValid()) {
+        g_theConsole->PrintError(Stringf("Fail to bind udp port %i", m_replyPort));
+        return;
+    }
+
+    m_isHandshaking = true;
+    m_handshakeStep = HANDSHAKE_REQUEST;
+    m_handshakeNonce = RollSecretNumber();
+    m_handshakeRetries = 0;
+    m_connectStartTime = GetCurrentTimeSeconds();
+    SendHandshakeStep(m_connectStartTime);
 }
 
 //////////////////////////////////////////////////////////////////////////
 void RemoteServer::BeginFrame()
 {
     Server::BeginFrame();
+    UpdateHandshake(GetCurrentTimeSeconds());
 
     Client* c = m_clients[0];
-    if(c->m_udpSocket){
+    if(c->m_transport){
         c->BeginFrame();
     }
 }
@@ -52,11 +73,20 @@ void RemoteServer::Shutdown()
 {
     if(!m_clients.empty()){
         Client* c = m_clients[0];
-        RemovePlayer(c);
+        if (!c->m_isQuiting) {
+            RemovePlayer(c);
+        }
         delete c;
         m_clients.clear();
     }
 
+    if (m_handshakeTransport) {
+        g_theNetIO->Flush();
+        g_theObserver->ForgetTransport(m_handshakeTransport);
+        delete m_handshakeTransport;
+        m_handshakeTransport = nullptr;
+    }
+
     m_theGame->ShutDown();
 
     delete m_theGame;
@@ -64,41 +94,78 @@ void RemoteServer::Shutdown()
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::CreateUDPSocket(std::string const& ip, int toPort, int bindPort, int identifier)
+// add player rides on the response, so the baseline starts as the accept goes out
+bool RemoteServer::HandleHandshakePackage(NetTransport* source, std::string_view content)
 {
-    Client* c = m_clients[0];
-    c->m_udpSocket = g_theNetwork->CreateUDPSocket(ip, toPort, bindPort);
-    c->m_identifier = identifier;
-
-    std::string str = MakeClientStartMessage(toPort, bindPort);
-    m_tcpClient->SendTCPMessage(str);
+    HandshakeInfo info;
+    if (!m_isHandshaking || source != m_handshakeTransport || !ParseHandshakePackage(content, info) || info.nonce != m_handshakeNonce) {
+        return false;
+    }
 
-    RequestAddPlayer();
+    double now = GetCurrentTimeSeconds();
+    switch (info.step) {
+    case HANDSHAKE_CHALLENGE:    {
+        if (m_handshakeStep != HANDSHAKE_REQUEST) {
+            return true;    //repeat of one already answered
+        }
+        m_handshakeStep = HANDSHAKE_RESPONSE;
+        m_handshakeToken = info.token;
+        m_handshakeRetries = 0;
+        m_addPlayerContent = MakeAddPlayerMessage(m_stringTables).substr(MESSAGE_HEADER_LEN);
+        SendHandshakeStep(now);
+        return true;
+    }
+    case HANDSHAKE_ACCEPT:    {
+        if (m_clients.empty()) {
+            return false;
+        }
+        Client* c = m_clients[0];
+        c->m_identifier = info.identifier;
+        m_ownPawnIndex = info.pawnIndex;
+        c->m_transport = m_handshakeTransport;
+        m_handshakeTransport = nullptr;
+        m_isHandshaking = false;
+        g_theConsole->PrintString(Rgba8::WHITE, Stringf("Joined %s:%i in %.0fms", m_serverIP.c_str(), m_serverPort, (now - m_connectStartTime) * 1000.0));
+        return true;
+    }
+    default:    {
+        return false;
+    }
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::SendReliableMessages()
+void RemoteServer::UpdateHandshake(double now)
 {
-    Server::SendReliableMessages();
-    m_clients[0]->m_shot = false;
-}
+    if (!m_isHandshaking || now - m_lastHandshakeSendTime < HANDSHAKE_RETRY_SECONDS) {
+        return;
+    }
 
-//////////////////////////////////////////////////////////////////////////
-void RemoteServer::SendOneMessage(std::string const& msg)
-{
-    Client* c = m_clients[0];
-    if (c->m_udpSocket==nullptr || !c->m_udpSocket->IsValid()) {
+    if (m_handshakeRetries >= HANDSHAKE_MAX_RETRIES) {
+        g_theConsole->PrintError(Stringf("No answer from server %s:%i", m_serverIP.c_str(), m_serverPort));
+        m_isHandshaking = false;
         return;
     }
+    m_handshakeRetries++;
+    SendHandshakeStep(now);
+}
 
-    std::string customMsg = msg;
-    NetworkPackageHeader* headerPtr = reinterpret_cast<NetworkPackageHeader*>(&customMsg[0]);
-    headerPtr->m_key = c->m_identifier;
-    c->m_udpSocket->SendUDPMessage(customMsg);
+//////////////////////////////////////////////////////////////////////////
+void RemoteServer::SendHandshakeStep(double now)
+{
+    HandshakeInfo info;
+    info.step = m_handshakeStep;
+    info.nonce = m_handshakeNonce;
+    info.token = m_handshakeToken;
+    info.replyIP = m_replyIP;
+    info.replyPort = m_replyPort;
+    info.addPlayer = m_addPlayerContent;
+    g_theObserver->SendPacket(m_handshakeTransport, MakeHandshakePackage(info), 0.f, true);
+    m_lastHandshakeSendTime = now;
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string const& content, int identifier, bool reliable)
+void RemoteServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string_view content, int identifier)
 {
     Client* c = m_clients[0];
     if (identifier != c->m_identifier) {
@@ -110,6 +177,22 @@ void RemoteServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header,
         HandleEntityCreateMessage(content);
         break;
     }
+    case MESSAGE_ENTITY_BASELINE:    {
+        if (ParseEntityBaselineMessage(content, m_baselineEntities, m_deletedEntities)) {
+            for (Entity* e : m_baselineEntities) {
+                StartupIfOwnPawn(e);
+            }
+        }
+        break;
+    }
+    case MESSAGE_STRING_TABLE:    {
+        //half adopted tables go back to local ones, server sees the hashes and keeps sending names
+        if (!ParseStringTableMessage(content, m_stringTables)) {
+            m_stringTables.BuildLocal(m_theGame);
+        }
+        c->InsertStringTableAckMsg(MakeSharedMessage(MakeStringTableAckMessage(m_stringTables)));
+        break;
+    }
     case MESSAGE_ENTITY_TRANSFORM:    {
         ParseEntityTransformMessage(content);
         break;
@@ -119,50 +202,59 @@ void RemoteServer::HandleUDPMessageOfIdentifier(NetMessageHeader const& header,
         break;
     }
     case MESSAGE_ENTITY_DELETE:    {
-        ParseEntityDeleteMessage(content);
+        int idx = -1;
+        if (!ParseEntityDeleteMessage(content, idx) && idx != -1) {
+            m_deletedEntities.insert(idx);
+        }
         break;
     }
     case MESSAGE_ACTOR_HEALTH:    {
         ParseActorHealthMessage(content);
         break;
     }
-    case MESSAGE_SOUND_PLAY:    {
-        size_t id = StringConvert(content.c_str(), 0ull);
-        if (!m_clients.empty()) {
-            m_clients[0]->PlaySoundOnClient(id);
+    case MESSAGE_PLAYER_STATE:    {
+        PlayerStateInfo state;
+        if (c->m_playerPawn && ParsePlayerStateMessage(content, state)) {
+            c->m_predictor.Reconcile(state, c->m_playerPawn, m_theGame);
         }
         break;
     }
-    case MESSAGE_ACK:    {
-        c->ReceiveACKMessage(content);
+    case MESSAGE_CLOCK_SYNC_RESPONSE:    {
+        double clientSendTime = 0.0;
+        double serverReceiveTime = 0.0;
+        double serverSendTime = 0.0;
+        if (ParseClockSyncResponseMessage(content, clientSendTime, serverReceiveTime, serverSendTime)) {
+            c->m_clockSync.AddSample(clientSendTime, serverReceiveTime, serverSendTime, c->m_lastReceiveTime);
+        }
         break;
     }
+    case MESSAGE_SOUND_PLAY:    {
+        size_t id = 0;
+        if (ParseSoundPlayMessage(content, id) && !m_clients.empty()) {
+            m_clients[0]->PlaySoundOnClient(id);
+        }
+        break;
     }
-
-    if (reliable) {
-        std::string ack = MakeReliableACKMessage(header.m_seqNo);
-        g_theObserver->AddMessage(ack);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::HandleEntityCreateMessage(std::string const& content)
+void RemoteServer::HandleEntityCreateMessage(std::string_view content)
 {
-    Entity* newEntity = ParseEntityCreateMessage(content);
-    Client* c = m_clients[0];
-    //TODO refine pawn assign logic
-    if (newEntity != nullptr && c->m_playerPawn == nullptr && 
-        c->m_identifier == newEntity->GetIndex()) {
-        c->Startup(newEntity, this);
-    }
+    Entity* newEntity = ParseEntityCreateMessage(content, m_deletedEntities);
+    StartupIfOwnPawn(newEntity);
 }
 
 //////////////////////////////////////////////////////////////////////////
-void RemoteServer::RequestAddPlayer()
+void RemoteServer::StartupIfOwnPawn(Entity* newEntity)
 {
-    std::string content = MakeMessageHeader(MESSAGE_ADD_PLAYER);
-    std::string pack = MakeTextPackage(content);
-    SendOneMessage(pack);
+    Client* c = m_clients[0];
+    //server names the pawn in its accept
+    if (newEntity != nullptr && c->m_playerPawn == nullptr && 
+        m_ownPawnIndex >= 0 && m_ownPawnIndex == newEntity->GetIndex()) {
+        c->Startup(newEntity, this);
+        newEntity->SetIsPlayerPawn(true);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -171,16 +263,6 @@ void RemoteServer::AddPlayer(Client* newClient)
     m_clients.push_back(newClient);
 }
 
-//////////////////////////////////////////////////////////////////////////
-void RemoteServer::RemoveTCPClient(TCPClient* client)
-{
-    UNUSED(client);
-
-    if (!m_clients.empty()) {
-        RemovePlayer(m_clients[0]);
-    }
-}
-
 //////////////////////////////////////////////////////////////////////////
 void RemoteServer::SwitchPlayerMap(Client* client, std::string const& mapName)
 {
@@ -188,7 +270,8 @@ void RemoteServer::SwitchPlayerMap(Client* client, std::string const& mapName)
         return;
     }
 
-    std::string msg = MakeEntityTeleportMessage(client->m_playerPawn->GetIndex(),mapName);
+    NetStringTables const* tables = m_stringTables.IsNegotiated() ? &m_stringTables : nullptr;
+    std::string msg = MakeEntityTeleportMessage(client->m_playerPawn->GetIndex(),mapName, tables);
     g_theObserver->AddMessage(msg);
 }
 
@@ -201,9 +284,12 @@ void RemoteServer::ActualSwitchPlayerMap(Entity* e, std::string const& mapName)
 //////////////////////////////////////////////////////////////////////////
 void RemoteServer::ReceiveInputInfo(Client* client)
 {
-    client->m_input.isFiring = client->m_shot;
-    std::string str = MakePlayerInputMessage(client->m_input);
-    g_theObserver->AddMessage(str);
+    //predict own pawn locally, server echoes last seq it processed
+    InputInfo& input = client->m_input;
+    input.seq = client->m_predictor.GetNextSeq();
+    input.deltaSeconds = (float)m_theGame->GetClock()->GetLastDeltaSeconds();
+    m_theGame->UpdatePlayerForInput(client->m_playerPawn, input, input.deltaSeconds);
+    client->m_predictor.RecordInput(input, client->m_playerPawn);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -213,14 +299,14 @@ void RemoteServer::PlayGlobalSound(SoundID id)
 }
 
 //////////////////////////////////////////////////////////////////////////
-Client* RemoteServer::GetClientOfUDPSocket(UDPSocket* soc) const
+Client* RemoteServer::GetClientOfTransport(NetTransport* transport) const
 {
     if (m_clients.empty()) {
         return nullptr;
     }
 
     Client* c = m_clients[0];
-    if (c->m_udpSocket == soc) {
+    if (c->m_transport == transport) {
         return c;
     }
 
@@ -243,12 +329,17 @@ Client* RemoteServer::GetClientOfPawnIndex(int idx) const
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool RemoteServer::IsPawnAPlayer(Entity* pawn) const
+double RemoteServer::GetServerTime() const
 {
     if (m_clients.empty()) {
-        return false;
+        return GetCurrentTimeSeconds();
     }
 
-    Entity* player = m_clients[0]->m_playerPawn;
-    return player == pawn;
+    return m_clients[0]->m_clockSync.GetEstimatedServerTime(GetCurrentTimeSeconds());
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool RemoteServer::IsServerTimeSynced() const
+{
+    return !m_clients.empty() && m_clients[0]->m_clockSync.IsSynced();
 }
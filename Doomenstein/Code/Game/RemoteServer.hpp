@@ -1,8 +1,9 @@
 #pragma once
 
 #include "Game/Server.hpp"
+#include <unordered_set>
 
-class TCPClient;
+class UDPTransport;
 
 // sync with authoritative server
 class RemoteServer : public Server 
@@ -10,21 +11,18 @@ class RemoteServer : public Server
 public:
     RemoteServer();
 
-    void SetUpTCPClient(std::string const& serverIp, int port);
+    void Connect(std::string const& serverIP, int serverPort, std::string const& replyIP);
 
     void BeginFrame() override;  //receive updated info
     void Render() const override;
     void Shutdown() override;
 
-    void CreateUDPSocket(std::string const& ip, int toPort, int bindPort, int identifier) override;
-    void SendReliableMessages() override;
-    void SendOneMessage(std::string const& msg) override;
-    void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string const& content, int identifier, bool reliable) override;
-    void HandleEntityCreateMessage(std::string const& content);
+    bool HandleHandshakePackage(NetTransport* source, std::string_view content) override;
+    void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string_view content, int identifier) override;
+    void HandleEntityCreateMessage(std::string_view content);
+    void StartupIfOwnPawn(Entity* newEntity);
 
-    void RequestAddPlayer();
     void AddPlayer(Client* newClient) override;
-    void RemoveTCPClient(TCPClient* client);
     void SwitchPlayerMap(Client* client, std::string const& mapName) override;
     void ActualSwitchPlayerMap(Entity* e, std::string const& mapName);
 
@@ -32,13 +30,35 @@ public:
 
     void PlayGlobalSound(SoundID id) override;
 
-    Client* GetClientOfUDPSocket(UDPSocket* soc) const override;
+    Client* GetClientOfTransport(NetTransport* transport) const override;
     Client* GetClientOfPawnIndex(int idx) const override;
-    bool IsPawnAPlayer(Entity* pawn) const override;
+
+    double GetServerTime() const override;
+    bool IsServerTimeSynced() const override;
 
 public:
     std::string m_serverIP;
+    int m_serverPort = 0;
+
+private:
+    void UpdateHandshake(double now);
+    void SendHandshakeStep(double now);
 
 private:
-    TCPClient* m_tcpClient = nullptr;
+    std::vector<Entity*> m_baselineEntities;
+    std::unordered_set<int> m_deletedEntities;  //deletes that came before their entity, late creates are dropped
+
+    //client transport lives here until the server accepts
+    UDPTransport* m_handshakeTransport = nullptr;
+    bool m_isHandshaking = false;
+    eHandshakeStep m_handshakeStep = HANDSHAKE_REQUEST;    //one being repeated
+    unsigned int m_handshakeNonce = 0;
+    unsigned int m_handshakeToken = 0;
+    int m_handshakeRetries = 0;
+    double m_lastHandshakeSendTime = 0.0;
+    double m_connectStartTime = 0.0;
+    std::string m_replyIP;
+    int m_replyPort = 0;
+    std::string m_addPlayerContent;
+    int m_ownPawnIndex = -1;    //from the accept, the packet key is never an entity index
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "Game/SendRateController.hpp"
+#include "Game/NetConnection.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+void SendRateController::Reset()
+{
+    m_sendRate = g_sendRatePerSec;
+    m_byteBudget = (float)CLIENT_SEND_BUDGET_BYTES;
+    m_lastLostPackets = 0;
+    m_cooldownSeconds = 0.f;
+    m_decreaseCount = 0;
+    m_isCongested = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// g_sendRatePerSec is the ceiling every connection climbs back up to
+void SendRateController::Update(ConnectionStats const& stats, float deltaSeconds)
+{
+    m_cooldownSeconds -= deltaSeconds;
+
+    long long newLost = stats.lostPackets - m_lastLostPackets;
+    m_lastLostPackets = stats.lostPackets;
+    bool isLossy = newLost > 0 && stats.lossRate > SEND_LOSS_THRESHOLD;
+    bool isDelayed = stats.rttSamples > 0 && stats.rtt > stats.minRtt * SEND_RTT_INFLATION + SEND_RTT_SLACK_SECONDS;
+    m_isCongested = isLossy || isDelayed;
+
+    if (m_isCongested) {
+        //back off at most once per round trip
+        if (m_cooldownSeconds <= 0.f) {
+            m_sendRate *= SEND_RATE_DECREASE_FACTOR;
+            m_byteBudget *= SEND_RATE_DECREASE_FACTOR;
+            m_cooldownSeconds = stats.rtt > SEND_DECREASE_COOLDOWN_SECONDS ? stats.rtt : SEND_DECREASE_COOLDOWN_SECONDS;
+            m_decreaseCount++;
+        }
+    }
+    else {
+        m_sendRate += SEND_RATE_INCREASE_PER_SEC * deltaSeconds;
+        m_byteBudget += SEND_BUDGET_INCREASE_PER_SEC * deltaSeconds;
+    }
+
+    m_sendRate = Clamp(m_sendRate, MIN_SEND_RATE_PER_SEC, g_sendRatePerSec);
+    m_byteBudget = Clamp(m_byteBudget, (float)MIN_SEND_BUDGET_BYTES, (float)CLIENT_SEND_BUDGET_BYTES);
+}
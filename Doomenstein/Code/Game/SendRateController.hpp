@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Game/GameCommon.hpp"
+
+struct ConnectionStats;
+
+constexpr float SEND_RATE_INCREASE_PER_SEC = 2.f;       //additive increase, Hz per second
+constexpr float SEND_RATE_DECREASE_FACTOR = .5f;        //multiplicative decrease
+constexpr float SEND_LOSS_THRESHOLD = .05f;
+constexpr float SEND_RTT_INFLATION = 2.f;               //congested if rtt above minRtt * this + slack
+constexpr float SEND_RTT_SLACK_SECONDS = .03f;
+constexpr float SEND_DECREASE_COOLDOWN_SECONDS = .5f;
+constexpr int MIN_SEND_BUDGET_BYTES = 256;
+constexpr float SEND_BUDGET_INCREASE_PER_SEC = 256.f;
+
+// per connection AIMD on send rate and byte budget from measured rtt and loss
+class SendRateController
+{
+public:
+    void Reset();
+    void Update(ConnectionStats const& stats, float deltaSeconds);
+
+    float GetSendRate() const {return m_sendRate;}
+    int GetByteBudget() const {return (int)m_byteBudget;}
+    int GetDecreaseCount() const {return m_decreaseCount;}
+    bool IsCongested() const {return m_isCongested;}
+
+private:
+    float m_sendRate = MAX_SEND_RATE_PER_SEC;
+    float m_byteBudget = (float)CLIENT_SEND_BUDGET_BYTES;
+    long long m_lastLostPackets = 0;
+    float m_cooldownSeconds = 0.f;
+    int m_decreaseCount = 0;
+    bool m_isCongested = false;
+};
\ No newline at end of file
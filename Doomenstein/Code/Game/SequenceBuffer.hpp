@@ -0,0 +1,54 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+// true if a is newer than b, handles wrap around
+inline bool IsSequenceGreaterThan(unsigned short a, unsigned short b)
+{
+    return ((a > b) && (a - b <= 32768)) ||
+        ((a < b) && (b - a > 32768));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// fixed ring indexed by sequence number, O(1) insert and find
+template<typename T, int SIZE>
+class SequenceBuffer
+{
+public:
+    T* Insert(unsigned short seq)
+    {
+        int idx = seq % SIZE;
+        m_sequences[idx] = seq;
+        m_valid[idx] = true;
+        m_entries[idx] = T();
+        return &m_entries[idx];
+    }
+
+    T* Find(unsigned short seq)
+    {
+        int idx = seq % SIZE;
+        if (m_valid[idx] && m_sequences[idx] == seq) {
+            return &m_entries[idx];
+        }
+        return nullptr;
+    }
+
+    void Remove(unsigned short seq)
+    {
+        int idx = seq % SIZE;
+        if (m_valid[idx] && m_sequences[idx] == seq) {
+            m_valid[idx] = false;
+        }
+    }
+
+    void Reset()
+    {
+        for (int i = 0; i < SIZE; i++) {
+            m_valid[i] = false;
+        }
+    }
+
+private:
+    T m_entries[SIZE];
+    unsigned short m_sequences[SIZE] = {};
+    bool m_valid[SIZE] = {};
+};
\ No newline at end of file
@@ -5,64 +5,12 @@
 #include "Game/MultiplayerGame.hpp"
 #include "Game/NetworkMessage.hpp"
 #include "Game/PlayerClient.hpp"
+#include "Game/Entity.hpp"
 #include "Game/App.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/NamedProperties.hpp"
-#include "Engine/Network/TCPData.hpp"
 #include "Engine/Network/NetworkCommon.hpp"
-#include "Engine/Network/TCPSocket.hpp"
-
-//////////////////////////////////////////////////////////////////////////
-COMMAND(TCPClientReceive,"on receive TCP client, data=... ptr=&(TCPClient)",EVENT_NETWORK)
-{
-    std::string data = args.GetValue("data","");
-    void* ptr = args.GetValue("ptr", (TCPClient*)nullptr);
-    if (g_theServer->m_isAuthoritative || data.empty()) {
-        return false;
-    }
-
-    TCPData tcpData(data.size(), &data[0]);
-    eNetworkPackageHeaderType type = tcpData.GetHeader();
-    switch (type)
-    {
-    case eNetworkPackageHeaderType::HEAD_SERVER_LISTEN:    {
-        return ParseClientConnectPackage(tcpData.GetContent());
-    }
-    case eNetworkPackageHeaderType::HEAD_CLIENT_CLOSE:    {
-        ((RemoteServer*)g_theServer)->RemoveTCPClient((TCPClient*)ptr);
-        return true;
-    }
-    default:{
-        return false;
-    }
-    }
-}
-
-//////////////////////////////////////////////////////////////////////////
-COMMAND(TCPServerFailOneClient, "server receive client tcp fail, data=... ptr=&(TCPSocket)", EVENT_NETWORK)
-{
-    std::string data = args.GetValue("data", "");
-    void* ptr = args.GetValue("ptr", (TCPSocket*)nullptr);
-    if (!g_theServer->m_isAuthoritative || data.empty()) {
-        return false;
-    }
-
-    TCPData tcpData(data.size(), &data[0]);
-    eNetworkPackageHeaderType type = tcpData.GetHeader();
-    switch (type)
-    {
-    case eNetworkPackageHeaderType::HEAD_CLIENT_START:    {
-        return ParseClientStartMessage(tcpData.GetContent(), (TCPSocket*)ptr);
-    }
-    case eNetworkPackageHeaderType::HEAD_CLIENT_CLOSE:    {
-        ((AuthoritativeServer*)g_theServer)->RemoveTCPClient((TCPSocket*)ptr);
-        return true;
-    }
-    default:    {
-        return false;
-    }
-    }
-}
+#include "Engine/Core/Time.hpp"
 
 //////////////////////////////////////////////////////////////////////////
 void Server::Startup(eGameType gameType)
@@ -81,6 +29,8 @@ void Server::Startup(eGameType gameType)
     }
 
     m_theGame->StartUp();
+    m_stringTables.BuildLocal(m_theGame);
+    m_stringTables.SetNegotiated(m_isAuthoritative);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -94,6 +44,9 @@ void Server::BeginFrame()
 //////////////////////////////////////////////////////////////////////////
 void Server::Update()
 {
+    if (m_isAuthoritative) {
+        m_tick++;
+    }
     m_theGame->UpdateLocal();
 
     for (size_t i=0;i<m_clients.size();) {
@@ -123,27 +76,59 @@ void Server::EndFrame()
 }
 
 //////////////////////////////////////////////////////////////////////////
-void Server::SendReliableMessages()
+void Server::SendMessages(std::vector<SharedMessage> const& msgs)
 {
     for (Client* c : m_clients) {
-        c->SendReliableMessages();
+        c->SendMessages(msgs);
     }
 }
 
 //////////////////////////////////////////////////////////////////////////
 void Server::RemovePlayer(Client* client)
 {
+    if (client->m_playerPawn) {
+        client->m_playerPawn->SetIsPlayerPawn(false);
+    }
     m_theGame->RemoveEntity(client->m_playerPawn);
     client->Shutdown();
 }
 
 //////////////////////////////////////////////////////////////////////////
 void Server::RemovePlayerOfIdentifier(int identifier)
+{
+    Client* c = GetClientOfIdentifier(identifier);
+    if (c && c->m_isRemote) {   //TODO server player not delete
+        RemovePlayer(c);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+Client* Server::GetClientOfIdentifier(int identifier) const
 {
     for (Client* c : m_clients) {
-        if (identifier == c->m_identifier && c->m_isRemote) {   //TODO server player not delete
-            RemovePlayer(c);
-            return;
+        if (c->m_identifier == identifier) {
+            return c;
         }
     }
+
+    return nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// per client transports: key must arrive on the transport it was handed out for,
+// the shared listen socket can't check that and routes on the key alone
+Client* Server::GetClientOfPacket(int identifier, NetTransport* transport) const
+{
+    Client* c = GetClientOfIdentifier(identifier);
+    if (c == nullptr || c->m_transport == nullptr || c->m_transport != transport) {
+        return nullptr;
+    }
+
+    return c;
+}
+
+//////////////////////////////////////////////////////////////////////////
+double Server::GetServerTime() const
+{
+    return GetCurrentTimeSeconds();
 }
@@ -1,12 +1,13 @@
 #pragma once
 
 #include "Game/Game.hpp"
+#include "Game/NetworkMessage.hpp"
+#include "Game/NetStringTable.hpp"
 #include <vector>
+#include <string_view>
 
 class Client; 
-class UDPSocket;
-class TCPClient;
-struct NetMessageHeader;
+class NetTransport;
 typedef size_t SoundID;
 
 class Server
@@ -22,10 +23,9 @@ public:
     virtual void EndFrame();
     virtual void Shutdown() = 0;
 
-    virtual void CreateUDPSocket(std::string const& ip, int toPort, int bindPort, int identifier) =0;
-    virtual void SendOneMessage(std::string const& msg) = 0;
-    virtual void SendReliableMessages();
-    virtual void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string const& content, int identifier, bool reliable)=0;
+    virtual bool HandleHandshakePackage(NetTransport* source, std::string_view content) =0;
+    virtual void SendMessages(std::vector<SharedMessage> const& msgs);
+    virtual void HandleUDPMessageOfIdentifier(NetMessageHeader const& header, std::string_view content, int identifier)=0;
 
     virtual void AddPlayer(Client* newClient) = 0;
     virtual void RemovePlayer(Client* client);
@@ -36,13 +36,19 @@ public:
 
     virtual void PlayGlobalSound(SoundID id) = 0;
 
-    virtual Client* GetClientOfUDPSocket(UDPSocket* soc) const = 0;
+    virtual Client* GetClientOfTransport(NetTransport* transport) const = 0;
+    virtual Client* GetClientOfIdentifier(int identifier) const;
+    virtual Client* GetClientOfPacket(int identifier, NetTransport* transport) const;
     virtual Client* GetClientOfPawnIndex(int idx) const =0;
-    virtual bool IsPawnAPlayer(Entity* pawn) const = 0;
+
+    virtual double GetServerTime() const;
+    virtual bool IsServerTimeSynced() const {return true;}
 
 public:
     Game* m_theGame = nullptr;
     bool m_isAuthoritative = true;
+    unsigned int m_tick = 0;    //server simulation tick, latest received on remote
+    NetStringTables m_stringTables;     //server's own, adopted by remote on join
 
     //Multi clients
     std::vector<Client*> m_clients;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+
+//////////////////////////////////////////////////////////////////////////
+// single producer single consumer ring, slots are reused so payload buffers keep capacity
+// producer: BeginPush, fill slot, EndPush; consumer: BeginPop, read slot, EndPop
+template<typename T, int SIZE>
+class SpscRing
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    T* BeginPush()
+    {
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= (unsigned int)SIZE) {
+            return nullptr;
+        }
+        return &m_slots[tail & (SIZE - 1)];
+    }
+
+    void EndPush()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    T* BeginPop()
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_slots[head & (SIZE - 1)];
+    }
+
+    void EndPop()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    int GetSize() const
+    {
+        return (int)(m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire));
+    }
+
+private:
+    T m_slots[SIZE];
+    std::atomic<unsigned int> m_head{0};    //written by consumer only
+    std::atomic<unsigned int> m_tail{0};    //written by producer only
+};
\ No newline at end of file
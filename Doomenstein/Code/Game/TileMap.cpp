@@ -212,7 +212,7 @@ bool TileMap::ResolveForTeleporterCollision(Entity* entityA, Entity* entityB)
         playerPawn = entityA;
     }
 
-    if (!g_theServer->IsPawnAPlayer(playerPawn)) {
+    if (!playerPawn->IsPlayerPawn()) {
         if (portal->m_destMap.empty() || portal->m_destMap == m_name) {
             TeleportEntity(playerPawn, portal->m_destPos, portal->m_destYawOffset);
             return true;
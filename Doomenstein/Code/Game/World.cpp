@@ -169,6 +169,16 @@ Map* World::GetMapFromName(std::string const& name) const
     else return nullptr;
 }
 
+//////////////////////////////////////////////////////////////////////////
+std::vector<std::string> World::GetMapNames() const
+{
+    std::vector<std::string> names;
+    for (auto iter = m_maps.begin(); iter != m_maps.end(); iter++) {
+        names.push_back(iter->first);
+    }
+    return names;
+}
+
 //////////////////////////////////////////////////////////////////////////
 std::string World::GetLoadedMapsNames() const
 {
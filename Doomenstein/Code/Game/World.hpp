@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "Engine/Core/EventSystem.hpp"
 
 class Map;
@@ -25,6 +26,7 @@ public:
     Entity* SpawnEntityAtPlayerStart(size_t playerIdx, std::string const& entityDefName);
 
     Game* GetTheGame() const {return m_theGame;}
+    std::vector<std::string> GetMapNames() const;
 
     bool SwitchMap(Entity* pawn, std::string const& mapName);
     bool SwitchMap(Entity* pawn,std::string const& mapName, Vec2 const& startPos, float startYaw);